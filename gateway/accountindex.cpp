@@ -0,0 +1,64 @@
+#include "pch.h"
+
+#include "accountindex.h"
+#include "script.h"
+#include "tools.h"
+
+bool AccountIndex::load(const std::string& directory)
+{
+	if (!boost::filesystem::is_directory(directory)) {
+		fmt::printf("ERROR - AccountIndex::load: %s is not a directory.\n", directory);
+		return false;
+	}
+
+	std::vector<boost::filesystem::path> files;
+	getFilesInDirectory(directory, ".usr", files);
+
+	for (const boost::filesystem::path& file : files) {
+		uint32_t account_number = 0;
+		try {
+			account_number = std::stoul(file.stem().string());
+		} catch (const std::exception&) {
+			continue;
+		}
+
+		// same layout Player::loadData reads from
+		const std::string filename = fmt::sprintf("%s/%02d/%d.usr", directory, account_number % 100, account_number);
+
+		std::string name;
+		if (readCharacterName(filename, name)) {
+			characters[account_number] = std::move(name);
+		}
+	}
+
+	return true;
+}
+
+const std::string* AccountIndex::getCharacterName(uint32_t account_number) const
+{
+	auto it = characters.find(account_number);
+	if (it == characters.end()) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
+bool AccountIndex::readCharacterName(const std::string& filename, std::string& name)
+{
+	ScriptReader script;
+	if (!script.loadScript(filename)) {
+		return false;
+	}
+
+	// the name comes first in every user file, nothing after it is needed
+	while (script.canRead()) {
+		script.nextToken();
+		if (script.getToken() == TOKEN_IDENTIFIER && script.getIdentifier() == "name") {
+			script.readSymbol('=');
+			name = script.readString();
+			return !name.empty();
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Character name of every account with a user file, read once from the usr directory tree
+// (usr/<account % 100>/<account>.usr) so character lists are answered without touching the disk.
+class AccountIndex
+{
+public:
+	explicit AccountIndex() = default;
+
+	bool load(const std::string& directory);
+
+	// nullptr if the account has no user file, the game server then logs it in with the default one
+	const std::string* getCharacterName(uint32_t account_number) const;
+
+	size_t size() const {
+		return characters.size();
+	}
+private:
+	static bool readCharacterName(const std::string& filename, std::string& name);
+
+	std::unordered_map<uint32_t, std::string> characters;
+};
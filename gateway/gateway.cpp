@@ -0,0 +1,149 @@
+#include "pch.h"
+
+#include "gateway.h"
+
+bool LoginGateway::run()
+{
+	boost::system::error_code error;
+	const boost::asio::ip::address address = boost::asio::ip::make_address(options.host, error);
+	if (error) {
+		fmt::printf("ERROR - LoginGateway::run: invalid address %s.\n", options.host);
+		return false;
+	}
+
+	const boost::asio::ip::address game_address = boost::asio::ip::make_address(options.game_host, error);
+	if (error || !game_address.is_v4()) {
+		fmt::printf("ERROR - LoginGateway::run: invalid game address %s.\n", options.game_host);
+		return false;
+	}
+	game_endpoint = boost::asio::ip::tcp::endpoint(game_address, options.game_port);
+
+	if (!loadIndex()) {
+		return false;
+	}
+
+	try {
+		const boost::asio::ip::tcp::endpoint endpoint(address, options.port);
+		acceptor.open(endpoint.protocol());
+		acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+		acceptor.set_option(boost::asio::ip::tcp::no_delay(true));
+		acceptor.bind(endpoint);
+		acceptor.listen();
+	} catch (boost::system::system_error& e) {
+		fmt::printf("ERROR - LoginGateway::run: %s.\n", e.what());
+		return false;
+	}
+
+	fmt::printf(">> Serving character lists on %s:%d for %s:%d.\n", options.host, options.port, options.game_host, options.game_port);
+
+	accept();
+	probeGame(boost::system::error_code());
+
+	signals.async_wait([this](const boost::system::error_code&, int) {
+		fmt::printf(">> Shutting down...\n");
+		io_context.stop();
+	});
+
+	std::thread refresh_thread(&LoginGateway::refreshIndex, this);
+
+	const uint32_t thread_count = std::max<uint32_t>(1, options.threads);
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads.emplace_back([this]() {
+			io_context.run();
+		});
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	{
+		std::lock_guard<std::mutex> lockClass(refresh_mutex);
+		stopping = true;
+	}
+	refresh_signal.notify_one();
+	refresh_thread.join();
+
+	fmt::printf(">> Served %d character lists, rejected %d requests.\n", served.load(), rejected.load());
+	return true;
+}
+
+void LoginGateway::accept()
+{
+	auto session = std::make_shared<LoginSession>(io_context, *this);
+	acceptor.async_accept(session->getSocket(), std::bind(&LoginGateway::onAccept, this, session, std::placeholders::_1));
+}
+
+void LoginGateway::onAccept(std::shared_ptr<LoginSession> session, const boost::system::error_code& error)
+{
+	if (error == boost::asio::error::operation_aborted) {
+		return;
+	}
+
+	if (!error) {
+		boost::asio::post(session->getSocket().get_executor(), std::bind(&LoginSession::start, session));
+	}
+
+	accept();
+}
+
+void LoginGateway::probeGame(const boost::system::error_code& error)
+{
+	if (error == boost::asio::error::operation_aborted) {
+		return;
+	}
+
+	// an accepted connection is all the gateway needs to know, the game server drops it right away
+	probe_socket.async_connect(game_endpoint, std::bind(&LoginGateway::onProbe, this, std::placeholders::_1));
+}
+
+void LoginGateway::onProbe(const boost::system::error_code& error)
+{
+	const bool online = !error;
+	if (game_online.exchange(online) != online) {
+		fmt::printf("INFO - LoginGateway::onProbe: game server at %s:%d is %s.\n", options.game_host, options.game_port, online ? "online" : "offline");
+	}
+
+	boost::system::error_code close_error;
+	probe_socket.close(close_error);
+
+	probe_timer.expires_after(GATEWAY_PROBE_INTERVAL);
+	probe_timer.async_wait(std::bind(&LoginGateway::probeGame, this, std::placeholders::_1));
+}
+
+bool LoginGateway::loadIndex()
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	auto new_index = std::make_shared<AccountIndex>();
+	if (!new_index->load(options.users)) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lockClass(index_mutex);
+
+	// refreshes only report when accounts were added or removed
+	if (!index || index->size() != new_index->size()) {
+		const int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		fmt::printf(">> Indexed %d accounts from %s in %d ms.\n", new_index->size(), options.users, elapsed);
+	}
+
+	index = std::move(new_index);
+	return true;
+}
+
+void LoginGateway::refreshIndex()
+{
+	if (options.refresh_seconds == 0) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lockClass(refresh_mutex);
+	while (!refresh_signal.wait_for(lockClass, std::chrono::seconds(options.refresh_seconds), [this]() { return stopping; })) {
+		// sessions keep answering from the old index while the new one is read
+		lockClass.unlock();
+		loadIndex();
+		lockClass.lock();
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "accountindex.h"
+#include "session.h"
+
+static constexpr std::chrono::seconds GATEWAY_PROBE_INTERVAL{ 5 };
+
+struct GatewayOptions
+{
+	std::string host = "0.0.0.0";
+	uint16_t port = 7171;
+	std::string game_host = "127.0.0.1";
+	uint16_t game_port = 7172;
+	std::string world = "RealOTS";
+	std::string users = "usr";
+	uint32_t threads = 1;
+	uint32_t refresh_seconds = 60;
+};
+
+// Serves the character list protocol in front of the game server. Logins are decrypted on the
+// gateway threads and answered from an AccountIndex that is rebuilt in the background, the game
+// server is only asked whether it accepts connections.
+class LoginGateway
+{
+public:
+	explicit LoginGateway(const GatewayOptions& options) :
+		options(options) {
+		//
+	}
+
+	LoginGateway(const LoginGateway&) = delete;
+	LoginGateway& operator=(const LoginGateway&) = delete;
+
+	bool run();
+
+	const GatewayOptions& getOptions() const {
+		return options;
+	}
+
+	bool isGameOnline() const {
+		return game_online;
+	}
+	std::shared_ptr<const AccountIndex> getIndex() {
+		std::lock_guard<std::mutex> lockClass(index_mutex);
+		return index;
+	}
+
+	// called from the session strands
+	void addServed() {
+		served++;
+	}
+	void addRejected() {
+		rejected++;
+	}
+private:
+	void accept();
+	void onAccept(std::shared_ptr<LoginSession> session, const boost::system::error_code& error);
+
+	void probeGame(const boost::system::error_code& error);
+	void onProbe(const boost::system::error_code& error);
+
+	bool loadIndex();
+	void refreshIndex();
+
+	GatewayOptions options;
+
+	boost::asio::io_context io_context;
+	boost::asio::ip::tcp::acceptor acceptor{ io_context };
+	boost::asio::signal_set signals{ io_context, SIGINT, SIGTERM };
+
+	// the probe timer and socket are only touched by their own handlers, one at a time
+	boost::asio::ip::tcp::endpoint game_endpoint;
+	boost::asio::steady_timer probe_timer{ io_context };
+	boost::asio::ip::tcp::socket probe_socket{ io_context };
+	std::atomic<bool> game_online{ false };
+
+	std::mutex index_mutex;
+	std::shared_ptr<const AccountIndex> index;
+
+	std::mutex refresh_mutex;
+	std::condition_variable refresh_signal;
+	bool stopping = false;
+
+	std::atomic<uint64_t> served{ 0 };
+	std::atomic<uint64_t> rejected{ 0 };
+};
@@ -0,0 +1,71 @@
+#include "pch.h"
+
+#include "gateway.h"
+#include "rsa.h"
+
+MessagePool g_messagepool;
+TRSA RSA;
+
+static void printUsage()
+{
+	fmt::printf("Usage: gateway [options]\n");
+	fmt::printf("  --host <address>      address to listen on (0.0.0.0)\n");
+	fmt::printf("  --port <port>         login port the clients connect to (7171)\n");
+	fmt::printf("  --game-host <address> IPv4 address of the game server sent to clients (127.0.0.1)\n");
+	fmt::printf("  --game-port <port>    game port of the game server (7172)\n");
+	fmt::printf("  --world <name>        world name shown in the character list (RealOTS)\n");
+	fmt::printf("  --users <directory>   user files of the game server (usr)\n");
+	fmt::printf("  --threads <count>     network threads (1)\n");
+	fmt::printf("  --refresh <seconds>   time between rebuilds of the account index, 0 never (60)\n");
+}
+
+int main(int argc, char** argv)
+{
+	fmt::printf(":: RealOTS login gateway - for Tibia 7.72\n\n");
+
+	GatewayOptions options;
+	for (int i = 1; i < argc; i++) {
+		const std::string option = argv[i];
+		if (option == "--help") {
+			printUsage();
+			return 0;
+		}
+
+		if (i + 1 >= argc) {
+			printUsage();
+			return 1;
+		}
+
+		const std::string value = argv[++i];
+		try {
+			if (option == "--host") {
+				options.host = value;
+			} else if (option == "--port") {
+				options.port = std::stoul(value);
+			} else if (option == "--game-host") {
+				options.game_host = value;
+			} else if (option == "--game-port") {
+				options.game_port = std::stoul(value);
+			} else if (option == "--world") {
+				options.world = value;
+			} else if (option == "--users") {
+				options.users = value;
+			} else if (option == "--threads") {
+				options.threads = std::stoul(value);
+			} else if (option == "--refresh") {
+				options.refresh_seconds = std::stoul(value);
+			} else {
+				printUsage();
+				return 1;
+			}
+		} catch (const std::exception&) {
+			fmt::printf("ERROR - main: invalid value '%s' for %s.\n", value, option);
+			return 1;
+		}
+	}
+
+	RSA.setKey(RSA_PRIME_P, RSA_PRIME_Q);
+
+	LoginGateway gateway(options);
+	return gateway.run() ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include "pch.h"
+
+#include "session.h"
+#include "gateway.h"
+
+void LoginSession::start()
+{
+	timer.expires_after(SESSION_TIMEOUT);
+	timer.async_wait(std::bind(&LoginSession::onTimeout, shared_from_this(), std::placeholders::_1));
+
+	boost::asio::async_read(socket, boost::asio::buffer(in_header),
+		std::bind(&LoginSession::onReadHeader, shared_from_this(), std::placeholders::_1));
+}
+
+void LoginSession::onReadHeader(const boost::system::error_code& error)
+{
+	if (error) {
+		close();
+		return;
+	}
+
+	const uint16_t size = static_cast<uint16_t>(in_header[0] | in_header[1] << 8);
+	if (size == 0 || size > SESSION_MAX_PACKET) {
+		close();
+		return;
+	}
+
+	msg = NetworkMessage(MessagePool::getSizeClass(size + NetworkMessage::HEADER_LENGTH + NetworkMessage::XTEA_MULTIPLE));
+	msg.setLength(size);
+
+	boost::asio::async_read(socket, boost::asio::buffer(msg.getBuffer(), size),
+		std::bind(&LoginSession::onReadBody, shared_from_this(), std::placeholders::_1));
+}
+
+void LoginSession::onReadBody(const boost::system::error_code& error)
+{
+	if (error) {
+		close();
+		return;
+	}
+
+	parseLogin();
+}
+
+void LoginSession::onTimeout(const boost::system::error_code& error)
+{
+	if (error == boost::asio::error::operation_aborted) {
+		return;
+	}
+
+	close();
+}
+
+void LoginSession::parseLogin()
+{
+	msg.setPosition(0);
+
+	// game logins go straight to the game server, the gateway only serves character lists
+	if (msg.readByte() != 0x01) {
+		gateway.addRejected();
+		close();
+		return;
+	}
+
+	// client os, version and the signatures of the data files
+	msg.skipBytes(16);
+	if (!msg.rsaDecrypt()) {
+		gateway.addRejected();
+		close();
+		return;
+	}
+
+	symmetric_key[0] = msg.readQuad();
+	symmetric_key[1] = msg.readQuad();
+	symmetric_key[2] = msg.readQuad();
+	symmetric_key[3] = msg.readQuad();
+
+	const uint32_t account_number = msg.readQuad();
+	msg.readStringView();
+
+	if (!gateway.isGameOnline()) {
+		sendDisconnect("The server is not online.\nPlease try again later.");
+		return;
+	}
+
+	std::shared_ptr<const AccountIndex> index = gateway.getIndex();
+	const std::string* name = index->getCharacterName(account_number);
+	sendCharacterList(name ? *name : "User File");
+}
+
+void LoginSession::sendCharacterList(const std::string& name)
+{
+	const GatewayOptions& options = gateway.getOptions();
+
+	NetworkMessage out;
+	out.writeByte(0x64);
+	out.writeByte(0x01);
+	out.writeString(name);
+	out.writeString(options.world);
+	out.writeQuad(inet_addr(options.game_host.c_str()));
+	out.writeWord(options.game_port);
+	out.writeWord(0x00);
+	sendMessage(std::move(out));
+
+	gateway.addServed();
+}
+
+void LoginSession::sendDisconnect(const std::string& text)
+{
+	NetworkMessage out;
+	out.writeByte(0x0A);
+	out.writeString(text);
+	sendMessage(std::move(out));
+
+	gateway.addRejected();
+}
+
+void LoginSession::sendMessage(NetworkMessage&& out)
+{
+	msg = std::move(out);
+	msg.writeHeader();
+	msg.xteaEncrypt(symmetric_key);
+	msg.writeHeader();
+
+	auto self = shared_from_this();
+	boost::asio::async_write(socket, boost::asio::buffer(msg.getBuffer(), msg.getLength()),
+		[self](const boost::system::error_code&, size_t) {
+			self->close();
+		});
+}
+
+void LoginSession::close()
+{
+	timer.cancel();
+
+	boost::system::error_code error;
+	socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
+	socket.close(error);
+}
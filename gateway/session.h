@@ -0,0 +1,48 @@
+#pragma once
+
+#include "networkmessage.h"
+
+class LoginGateway;
+
+static constexpr uint16_t SESSION_MAX_PACKET = 1024;
+static constexpr std::chrono::seconds SESSION_TIMEOUT{ 10 };
+
+// One character list request: reads the login packet, answers it and closes the socket.
+// All handlers of a session run on its own strand.
+class LoginSession : public std::enable_shared_from_this<LoginSession>
+{
+public:
+	explicit LoginSession(boost::asio::io_context& io_context, LoginGateway& gateway) :
+		gateway(gateway),
+		strand(io_context.get_executor()),
+		socket(strand),
+		timer(strand) {
+		//
+	}
+
+	boost::asio::ip::tcp::socket& getSocket() {
+		return socket;
+	}
+
+	void start();
+private:
+	void onReadHeader(const boost::system::error_code& error);
+	void onReadBody(const boost::system::error_code& error);
+	void onTimeout(const boost::system::error_code& error);
+
+	void parseLogin();
+	void sendCharacterList(const std::string& name);
+	void sendDisconnect(const std::string& text);
+	void sendMessage(NetworkMessage&& msg);
+	void close();
+
+	LoginGateway& gateway;
+	boost::asio::strand<boost::asio::io_context::executor_type> strand;
+	boost::asio::ip::tcp::socket socket;
+	boost::asio::steady_timer timer;
+
+	std::array<uint8_t, NetworkMessage::HEADER_LENGTH> in_header;
+	NetworkMessage msg;
+
+	uint32_t symmetric_key[4]{};
+};
@@ -0,0 +1,344 @@
+#include "pch.h"
+
+#include "bot.h"
+#include "loadgen.h"
+#include "xtea.h"
+#include "rsa.h"
+
+static constexpr size_t RSA_BLOCK_SIZE = 128;
+static constexpr uint16_t CLIENT_OS = 2;
+static constexpr uint16_t CLIENT_VERSION = 772;
+static constexpr auto PING_INTERVAL = std::chrono::seconds(5);
+static constexpr auto ANSWER_TIMEOUT = std::chrono::seconds(5);
+
+static const char* TALK_TEXTS[] = { "hi", "hello there", "anyone selling a sword?", "trade", "bye" };
+
+static void writeWord(std::vector<uint8_t>& buffer, uint16_t value)
+{
+	buffer.push_back(static_cast<uint8_t>(value));
+	buffer.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+static void writeQuad(std::vector<uint8_t>& buffer, uint32_t value)
+{
+	writeWord(buffer, static_cast<uint16_t>(value));
+	writeWord(buffer, static_cast<uint16_t>(value >> 16));
+}
+
+static void writeString(std::vector<uint8_t>& buffer, const std::string& value)
+{
+	writeWord(buffer, static_cast<uint16_t>(value.size()));
+	buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+static void writePosition(std::vector<uint8_t>& buffer, uint16_t x, uint16_t y, uint8_t z)
+{
+	writeWord(buffer, x);
+	writeWord(buffer, y);
+	buffer.push_back(z);
+}
+
+static void rsaEncrypt(uint8_t* block)
+{
+	// public half of the server key in rsa.h, n = p * q and e = 65537
+	mpz_t p, q, m, n, c;
+	mpz_init2(m, 1024);
+	mpz_init2(n, 1024);
+	mpz_init2(c, 1024);
+	mpz_init_set_str(p, RSA_PRIME_P, 10);
+	mpz_init_set_str(q, RSA_PRIME_Q, 10);
+	mpz_mul(n, p, q);
+
+	mpz_import(m, RSA_BLOCK_SIZE, 1, 1, 0, 0, block);
+	mpz_powm_ui(c, m, 65537, n);
+
+	// left pad the result to the block size
+	size_t count = (mpz_sizeinbase(c, 2) + 7) / 8;
+	memset(block, 0, RSA_BLOCK_SIZE - count);
+	mpz_export(block + RSA_BLOCK_SIZE - count, &count, 1, 1, 0, 0, c);
+
+	mpz_clear(p);
+	mpz_clear(q);
+	mpz_clear(m);
+	mpz_clear(n);
+	mpz_clear(c);
+}
+
+Bot::Bot(boost::asio::io_context& io_context, LoadGenerator& generator, uint32_t account_number) :
+	generator(generator),
+	socket(boost::asio::make_strand(io_context)),
+	action_timer(socket.get_executor()),
+	random(account_number),
+	account_number(account_number)
+{
+	for (uint32_t& key : symmetric_key) {
+		key = random();
+	}
+}
+
+void Bot::start(const boost::asio::ip::tcp::endpoint& endpoint)
+{
+	pending_action = BOT_ACTION_LOGIN;
+	pending_time = std::chrono::steady_clock::now();
+	socket.async_connect(endpoint, std::bind(&Bot::onConnect, shared_from_this(), std::placeholders::_1));
+}
+
+void Bot::stop()
+{
+	boost::asio::post(socket.get_executor(), [self = shared_from_this()]() {
+		if (self->stopped) {
+			return;
+		}
+
+		self->stopped = true;
+		self->action_timer.cancel();
+
+		boost::system::error_code error;
+		self->socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
+		self->socket.close(error);
+
+		self->generator.onDisconnected(self->logged_in);
+	});
+}
+
+void Bot::onConnect(const boost::system::error_code& error)
+{
+	if (error) {
+		fmt::printf("ERROR - Bot::onConnect: account %d: %s.\n", account_number, error.message());
+		generator.addFailure(BOT_ACTION_LOGIN);
+		stop();
+		return;
+	}
+
+	boost::system::error_code option_error;
+	socket.set_option(boost::asio::ip::tcp::no_delay(true), option_error);
+
+	sendLogin();
+	readHeader();
+}
+
+void Bot::readHeader()
+{
+	boost::asio::async_read(socket, boost::asio::buffer(in_header),
+		std::bind(&Bot::onReadHeader, shared_from_this(), std::placeholders::_1));
+}
+
+void Bot::onReadHeader(const boost::system::error_code& error)
+{
+	if (error) {
+		if (!logged_in) {
+			generator.addFailure(BOT_ACTION_LOGIN);
+		}
+		stop();
+		return;
+	}
+
+	const uint16_t size = static_cast<uint16_t>(in_header[0] | in_header[1] << 8);
+	if (size == 0 || size % 8 != 0) {
+		fmt::printf("ERROR - Bot::onReadHeader: account %d received a frame of %d bytes.\n", account_number, size);
+		stop();
+		return;
+	}
+
+	in_body.resize(size);
+	boost::asio::async_read(socket, boost::asio::buffer(in_body),
+		std::bind(&Bot::onReadBody, shared_from_this(), std::placeholders::_1));
+}
+
+void Bot::onReadBody(const boost::system::error_code& error)
+{
+	if (error) {
+		stop();
+		return;
+	}
+
+	XTEA::decrypt(in_body.data(), static_cast<uint32_t>(in_body.size()), symmetric_key);
+
+	const uint16_t length = static_cast<uint16_t>(in_body[0] | in_body[1] << 8);
+	if (static_cast<size_t>(length) + 2 > in_body.size()) {
+		fmt::printf("ERROR - Bot::onReadBody: account %d received a frame that failed to decrypt.\n", account_number);
+		stop();
+		return;
+	}
+
+	parseFrame(in_body.data() + 2, length);
+	if (!stopped) {
+		readHeader();
+	}
+}
+
+void Bot::parseFrame(const uint8_t* payload, uint16_t length)
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	if (!logged_in) {
+		// the first frame is either the game init or a login error
+		if (length == 0 || payload[0] != 0x0A) {
+			const std::string reason = length > 3 ? std::string(reinterpret_cast<const char*>(payload + 3), std::min<size_t>(length - 3, payload[1] | payload[2] << 8)) : "unknown";
+			fmt::printf("ERROR - Bot::parseFrame: account %d could not log in: %s\n", account_number, reason);
+			generator.addFailure(BOT_ACTION_LOGIN);
+			stop();
+			return;
+		}
+
+		logged_in = true;
+		last_ping = now;
+		generator.onLoggedIn();
+	}
+
+	// the next frame after a command is taken as its answer, the server only answers once per beat
+	if (pending_action != BOT_ACTION_COUNT) {
+		generator.addLatency(pending_action, std::chrono::duration_cast<std::chrono::microseconds>(now - pending_time).count());
+		pending_action = BOT_ACTION_COUNT;
+		scheduleAction();
+	}
+}
+
+void Bot::scheduleAction()
+{
+	// spread the bots so they do not all act on the same beat
+	const uint32_t interval = generator.getOptions().action_interval;
+	action_timer.expires_after(std::chrono::milliseconds(interval / 2 + random() % (interval + 1)));
+	action_timer.async_wait(std::bind(&Bot::onActionTimer, shared_from_this(), std::placeholders::_1));
+}
+
+void Bot::onActionTimer(const boost::system::error_code& error)
+{
+	if (error || stopped) {
+		return;
+	}
+
+	if (pending_action != BOT_ACTION_COUNT) {
+		generator.addFailure(pending_action);
+		pending_action = BOT_ACTION_COUNT;
+	}
+
+	// the server drops players that did not answer a ping for a minute
+	const auto now = std::chrono::steady_clock::now();
+	if (now - last_ping >= PING_INTERVAL) {
+		last_ping = now;
+		sendCommand({ 30 });
+	}
+
+	doAction(generator.pickAction(random));
+}
+
+void Bot::doAction(BotAction_t action)
+{
+	const LoadOptions& options = generator.getOptions();
+
+	std::vector<uint8_t> payload;
+	switch (action) {
+		case BOT_ACTION_WALK: {
+			static const uint8_t directions[] = { 101, 102, 103, 104, 106, 107, 108, 109 };
+			payload.push_back(directions[random() % 8]);
+			break;
+		}
+
+		case BOT_ACTION_TALK: {
+			payload.push_back(150);
+			payload.push_back(1); // say
+			writeString(payload, TALK_TEXTS[random() % (sizeof(TALK_TEXTS) / sizeof(TALK_TEXTS[0]))]);
+			break;
+		}
+
+		case BOT_ACTION_MOVE: {
+			// swap whatever is in the hands, a wrong type id still goes through the whole move path
+			const bool left_to_right = random() % 2 == 0;
+			payload.push_back(120);
+			writePosition(payload, 0xFFFF, left_to_right ? 6 : 5, 0);
+			writeWord(payload, options.move_type_id);
+			payload.push_back(0);
+			writePosition(payload, 0xFFFF, left_to_right ? 5 : 6, 0);
+			payload.push_back(1);
+			break;
+		}
+
+		case BOT_ACTION_SPELL: {
+			payload.push_back(150);
+			payload.push_back(1); // say
+			writeString(payload, options.spells.empty() ? "exura" : options.spells[random() % options.spells.size()]);
+			break;
+		}
+
+		default:
+			scheduleAction();
+			return;
+	}
+
+	pending_action = action;
+	pending_time = std::chrono::steady_clock::now();
+	sendCommand(payload);
+
+	// an unanswered command counts as failed and the bot moves on
+	action_timer.expires_after(ANSWER_TIMEOUT);
+	action_timer.async_wait(std::bind(&Bot::onActionTimer, shared_from_this(), std::placeholders::_1));
+}
+
+void Bot::sendLogin()
+{
+	std::vector<uint8_t> block;
+	block.reserve(RSA_BLOCK_SIZE);
+	block.push_back(0);
+	for (uint32_t key : symmetric_key) {
+		writeQuad(block, key);
+	}
+	block.push_back(0); // gamemaster flag
+	writeQuad(block, account_number);
+	writeString(block, fmt::sprintf("Bot %d", account_number));
+	writeString(block, "");
+	while (block.size() < RSA_BLOCK_SIZE) {
+		block.push_back(static_cast<uint8_t>(random()));
+	}
+	rsaEncrypt(block.data());
+
+	std::vector<uint8_t> frame;
+	frame.reserve(2 + 5 + RSA_BLOCK_SIZE);
+	writeWord(frame, static_cast<uint16_t>(5 + RSA_BLOCK_SIZE));
+	frame.push_back(0x0A);
+	writeWord(frame, CLIENT_OS);
+	writeWord(frame, CLIENT_VERSION);
+	frame.insert(frame.end(), block.begin(), block.end());
+	writeFrame(std::move(frame));
+}
+
+void Bot::sendCommand(const std::vector<uint8_t>& payload)
+{
+	// size, then the encrypted inner length and payload padded to the XTEA block size
+	const size_t body_length = (2 + payload.size() + 7) & ~static_cast<size_t>(7);
+
+	std::vector<uint8_t> frame;
+	frame.reserve(2 + body_length);
+	writeWord(frame, static_cast<uint16_t>(body_length));
+	writeWord(frame, static_cast<uint16_t>(payload.size()));
+	frame.insert(frame.end(), payload.begin(), payload.end());
+	frame.resize(2 + body_length, 0x33);
+
+	XTEA::encrypt(frame.data() + 2, static_cast<uint32_t>(body_length), symmetric_key);
+	writeFrame(std::move(frame));
+}
+
+void Bot::writeFrame(std::vector<uint8_t>&& frame)
+{
+	out_frames.emplace_back(std::move(frame));
+	if (out_frames.size() > 1) {
+		return;
+	}
+
+	boost::asio::async_write(socket, boost::asio::buffer(out_frames.front()),
+		std::bind(&Bot::onWrite, shared_from_this(), std::placeholders::_1));
+}
+
+void Bot::onWrite(const boost::system::error_code& error)
+{
+	if (error) {
+		stop();
+		return;
+	}
+
+	out_frames.pop_front();
+	if (!out_frames.empty()) {
+		boost::asio::async_write(socket, boost::asio::buffer(out_frames.front()),
+			std::bind(&Bot::onWrite, shared_from_this(), std::placeholders::_1));
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+class LoadGenerator;
+
+enum BotAction_t : uint8_t
+{
+	BOT_ACTION_LOGIN,
+	BOT_ACTION_WALK,
+	BOT_ACTION_TALK,
+	BOT_ACTION_MOVE,
+	BOT_ACTION_SPELL,
+
+	BOT_ACTION_COUNT,
+};
+
+// One scripted client: logs in with the 7.72 game protocol, then keeps picking an action from the
+// configured mix and measures the time until the server sends the next frame back.
+// All handlers of a bot run on its own strand.
+class Bot : public std::enable_shared_from_this<Bot>
+{
+public:
+	explicit Bot(boost::asio::io_context& io_context, LoadGenerator& generator, uint32_t account_number);
+
+	void start(const boost::asio::ip::tcp::endpoint& endpoint);
+	void stop();
+private:
+	void onConnect(const boost::system::error_code& error);
+	void readHeader();
+	void onReadHeader(const boost::system::error_code& error);
+	void onReadBody(const boost::system::error_code& error);
+	void parseFrame(const uint8_t* payload, uint16_t length);
+
+	void scheduleAction();
+	void onActionTimer(const boost::system::error_code& error);
+	void doAction(BotAction_t action);
+
+	void sendLogin();
+	void sendCommand(const std::vector<uint8_t>& payload);
+	void writeFrame(std::vector<uint8_t>&& frame);
+	void onWrite(const boost::system::error_code& error);
+
+	LoadGenerator& generator;
+	boost::asio::ip::tcp::socket socket;
+	boost::asio::steady_timer action_timer;
+	std::mt19937 random;
+
+	uint32_t account_number;
+	uint32_t symmetric_key[4];
+
+	std::array<uint8_t, 2> in_header;
+	std::vector<uint8_t> in_body;
+
+	// frames waiting for the write in flight
+	std::deque<std::vector<uint8_t>> out_frames;
+
+	// command whose answer is being timed
+	BotAction_t pending_action = BOT_ACTION_COUNT;
+	std::chrono::steady_clock::time_point pending_time;
+	std::chrono::steady_clock::time_point last_ping;
+
+	bool logged_in = false;
+	bool stopped = false;
+};
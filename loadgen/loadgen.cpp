@@ -0,0 +1,168 @@
+#include "pch.h"
+
+#include "loadgen.h"
+
+static constexpr auto PROGRESS_INTERVAL = std::chrono::seconds(10);
+
+bool LoadGenerator::run()
+{
+	boost::system::error_code error;
+	const boost::asio::ip::address address = boost::asio::ip::make_address(options.host, error);
+	if (error) {
+		fmt::printf("ERROR - LoadGenerator::run: invalid address %s.\n", options.host);
+		return false;
+	}
+
+	// never point this at somebody else's server
+	if (!address.is_loopback()) {
+		fmt::printf("ERROR - LoadGenerator::run: %s is not a loopback address.\n", options.host);
+		return false;
+	}
+
+	endpoint = boost::asio::ip::tcp::endpoint(address, options.port);
+	bots.reserve(options.clients);
+
+	fmt::printf(">> Starting %d clients against %s:%d over %d seconds.\n", options.clients, options.host, options.port, options.ramp_seconds);
+
+	spawn_timer.expires_after(std::chrono::milliseconds(0));
+	spawn_timer.async_wait(std::bind(&LoadGenerator::spawnBot, this, std::placeholders::_1));
+	progress_timer.expires_after(PROGRESS_INTERVAL);
+	progress_timer.async_wait(std::bind(&LoadGenerator::printProgress, this, std::placeholders::_1));
+
+	const uint32_t thread_count = options.threads != 0 ? options.threads : std::max<uint32_t>(1, std::thread::hardware_concurrency());
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads.emplace_back([this]() {
+			io_context.run();
+		});
+	}
+
+	std::this_thread::sleep_for(std::chrono::seconds(options.ramp_seconds + options.duration_seconds));
+
+	boost::asio::post(strand, [this]() {
+		spawn_timer.cancel();
+		progress_timer.cancel();
+		for (const std::shared_ptr<Bot>& bot : bots) {
+			bot->stop();
+		}
+	});
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	printStatistics();
+	return true;
+}
+
+BotAction_t LoadGenerator::pickAction(std::mt19937& random) const
+{
+	uint32_t total_weight = 0;
+	for (uint32_t weight : options.weights) {
+		total_weight += weight;
+	}
+
+	if (total_weight == 0) {
+		return BOT_ACTION_COUNT;
+	}
+
+	uint32_t roll = random() % total_weight;
+	for (uint8_t i = BOT_ACTION_WALK; i != BOT_ACTION_COUNT; i++) {
+		if (roll < options.weights[i]) {
+			return static_cast<BotAction_t>(i);
+		}
+		roll -= options.weights[i];
+	}
+
+	return BOT_ACTION_COUNT;
+}
+
+void LoadGenerator::addLatency(BotAction_t action, int64_t microseconds)
+{
+	std::lock_guard<std::mutex> lockClass(statistics_mutex);
+	statistics[action].samples.push_back(microseconds);
+}
+
+void LoadGenerator::addFailure(BotAction_t action)
+{
+	std::lock_guard<std::mutex> lockClass(statistics_mutex);
+	statistics[action].failures++;
+}
+
+void LoadGenerator::onLoggedIn()
+{
+	online++;
+}
+
+void LoadGenerator::onDisconnected(bool logged_in)
+{
+	if (logged_in) {
+		online--;
+	}
+	disconnected++;
+}
+
+void LoadGenerator::spawnBot(const boost::system::error_code& error)
+{
+	if (error || bots.size() >= options.clients) {
+		return;
+	}
+
+	const uint32_t account_number = options.first_account + static_cast<uint32_t>(bots.size());
+	bots.emplace_back(std::make_shared<Bot>(io_context, *this, account_number));
+	bots.back()->start(endpoint);
+
+	if (bots.size() < options.clients) {
+		// clients are spread evenly over the ramp up time
+		const int64_t ramp_microseconds = static_cast<int64_t>(options.ramp_seconds) * 1000000;
+		spawn_timer.expires_at(spawn_timer.expiry() + std::chrono::microseconds(ramp_microseconds / options.clients));
+		spawn_timer.async_wait(std::bind(&LoadGenerator::spawnBot, this, std::placeholders::_1));
+	}
+}
+
+void LoadGenerator::printProgress(const boost::system::error_code& error)
+{
+	if (error) {
+		return;
+	}
+
+	uint64_t answers = 0;
+	uint64_t failures = 0;
+	{
+		std::lock_guard<std::mutex> lockClass(statistics_mutex);
+		for (const LatencyStatistics& action_statistics : statistics) {
+			answers += action_statistics.samples.size();
+			failures += action_statistics.failures;
+		}
+	}
+
+	fmt::printf(">> %d started, %d online, %d disconnected, %d answers, %d failures.\n", bots.size(), online.load(), disconnected.load(), answers, failures);
+
+	progress_timer.expires_after(PROGRESS_INTERVAL);
+	progress_timer.async_wait(std::bind(&LoadGenerator::printProgress, this, std::placeholders::_1));
+}
+
+void LoadGenerator::printStatistics()
+{
+	static const char* action_names[BOT_ACTION_COUNT] = { "login", "walk", "talk", "move", "spell" };
+
+	std::lock_guard<std::mutex> lockClass(statistics_mutex);
+
+	fmt::printf(">> %-6s %8s %8s %9s %9s %9s %9s\n", "action", "answers", "failed", "p50 ms", "p90 ms", "p99 ms", "max ms");
+	for (uint8_t i = BOT_ACTION_LOGIN; i != BOT_ACTION_COUNT; i++) {
+		LatencyStatistics& action_statistics = statistics[i];
+		std::vector<int64_t>& samples = action_statistics.samples;
+		if (samples.empty()) {
+			fmt::printf(">> %-6s %8d %8d\n", action_names[i], 0, action_statistics.failures);
+			continue;
+		}
+
+		std::sort(samples.begin(), samples.end());
+		const auto percentile = [&samples](size_t percent) {
+			return samples[(samples.size() - 1) * percent / 100] / 1000.0;
+		};
+
+		fmt::printf(">> %-6s %8d %8d %9.2f %9.2f %9.2f %9.2f\n", action_names[i], samples.size(), action_statistics.failures,
+			percentile(50), percentile(90), percentile(99), samples.back() / 1000.0);
+	}
+}
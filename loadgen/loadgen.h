@@ -0,0 +1,74 @@
+#pragma once
+
+#include "bot.h"
+
+struct LoadOptions
+{
+	std::string host = "127.0.0.1";
+	uint16_t port = 7172;
+	uint32_t clients = 100;
+	uint32_t threads = 0;
+	uint32_t first_account = 1;
+	uint32_t ramp_seconds = 10;
+	uint32_t duration_seconds = 60;
+	uint32_t action_interval = 500;
+	uint16_t move_type_id = 0;
+
+	// chance of each action per step, logins are not picked
+	std::array<uint32_t, BOT_ACTION_COUNT> weights{ 0, 60, 15, 15, 10 };
+	std::vector<std::string> spells{ "exura", "utevo lux", "exani tera" };
+};
+
+struct LatencyStatistics
+{
+	std::vector<int64_t> samples;
+	uint64_t failures = 0;
+};
+
+// Starts options.clients bots against a local server, spread evenly over the ramp up time,
+// and reports per action latency percentiles when the run ends.
+class LoadGenerator
+{
+public:
+	explicit LoadGenerator(const LoadOptions& options) :
+		options(options) {
+		//
+	}
+
+	LoadGenerator(const LoadGenerator&) = delete;
+	LoadGenerator& operator=(const LoadGenerator&) = delete;
+
+	bool run();
+
+	const LoadOptions& getOptions() const {
+		return options;
+	}
+
+	BotAction_t pickAction(std::mt19937& random) const;
+
+	// called from the bot strands
+	void addLatency(BotAction_t action, int64_t microseconds);
+	void addFailure(BotAction_t action);
+	void onLoggedIn();
+	void onDisconnected(bool logged_in);
+private:
+	void spawnBot(const boost::system::error_code& error);
+	void printProgress(const boost::system::error_code& error);
+	void printStatistics();
+
+	LoadOptions options;
+
+	boost::asio::io_context io_context;
+	boost::asio::ip::tcp::endpoint endpoint;
+	// spawning, progress and shutdown share the bot list
+	boost::asio::strand<boost::asio::io_context::executor_type> strand{ io_context.get_executor() };
+	boost::asio::steady_timer spawn_timer{ strand };
+	boost::asio::steady_timer progress_timer{ strand };
+	std::vector<std::shared_ptr<Bot>> bots;
+
+	std::mutex statistics_mutex;
+	std::array<LatencyStatistics, BOT_ACTION_COUNT> statistics;
+
+	std::atomic<uint32_t> online{ 0 };
+	std::atomic<uint32_t> disconnected{ 0 };
+};
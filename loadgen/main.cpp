@@ -0,0 +1,92 @@
+#include "pch.h"
+
+#include "loadgen.h"
+
+static void printUsage()
+{
+	fmt::printf("Usage: loadgen [options]\n");
+	fmt::printf("  --host <address>      loopback address of the server (127.0.0.1)\n");
+	fmt::printf("  --port <port>         game port (7172)\n");
+	fmt::printf("  --clients <count>     number of bots (100)\n");
+	fmt::printf("  --account <number>    account of the first bot, the rest follow in order (1)\n");
+	fmt::printf("  --ramp <seconds>      time over which the bots log in (10)\n");
+	fmt::printf("  --duration <seconds>  time to keep running after the ramp (60)\n");
+	fmt::printf("  --interval <ms>       average time between the actions of a bot (500)\n");
+	fmt::printf("  --threads <count>     network threads, 0 uses one per core (0)\n");
+	fmt::printf("  --mix <w,t,m,s>       weights of walking, talking, moving items and casting (60,15,15,10)\n");
+	fmt::printf("  --item <type id>      type id of the item the bots move between their hands (0)\n");
+}
+
+static bool parseMix(const std::string& value, LoadOptions& options)
+{
+	std::istringstream stream(value);
+	std::string weight;
+	uint8_t action = BOT_ACTION_WALK;
+	while (std::getline(stream, weight, ',')) {
+		if (action == BOT_ACTION_COUNT) {
+			return false;
+		}
+		options.weights[action++] = std::stoul(weight);
+	}
+	return action == BOT_ACTION_COUNT;
+}
+
+int main(int argc, char** argv)
+{
+	fmt::printf(":: RealOTS load generator - for Tibia 7.72\n\n");
+
+	LoadOptions options;
+	for (int i = 1; i < argc; i++) {
+		const std::string option = argv[i];
+		if (option == "--help") {
+			printUsage();
+			return 0;
+		}
+
+		if (i + 1 >= argc) {
+			printUsage();
+			return 1;
+		}
+
+		const std::string value = argv[++i];
+		try {
+			if (option == "--host") {
+				options.host = value;
+			} else if (option == "--port") {
+				options.port = std::stoul(value);
+			} else if (option == "--clients") {
+				options.clients = std::stoul(value);
+			} else if (option == "--account") {
+				options.first_account = std::stoul(value);
+			} else if (option == "--ramp") {
+				options.ramp_seconds = std::stoul(value);
+			} else if (option == "--duration") {
+				options.duration_seconds = std::stoul(value);
+			} else if (option == "--interval") {
+				options.action_interval = std::max<uint32_t>(1, std::stoul(value));
+			} else if (option == "--threads") {
+				options.threads = std::stoul(value);
+			} else if (option == "--mix") {
+				if (!parseMix(value, options)) {
+					fmt::printf("ERROR - main: --mix needs four weights.\n");
+					return 1;
+				}
+			} else if (option == "--item") {
+				options.move_type_id = std::stoul(value);
+			} else {
+				printUsage();
+				return 1;
+			}
+		} catch (const std::exception&) {
+			fmt::printf("ERROR - main: invalid value '%s' for %s.\n", value, option);
+			return 1;
+		}
+	}
+
+	if (options.clients == 0) {
+		return 0;
+	}
+
+	LoadGenerator generator(options);
+	return generator.run() ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#include "pch.h"
+
+#include "capture.h"
+#include "connection.h"
+#include "game.h"
+#include "config.h"
+
+Capture::~Capture()
+{
+	close();
+}
+
+bool Capture::open(const std::string& filename, uint32_t seed)
+{
+	std::lock_guard<std::mutex> lockClass(mutex);
+
+	file = fopen(filename.c_str(), "wb");
+	if (!file) {
+		fmt::printf("ERROR - Capture::open: cannot create %s.\n", filename);
+		return false;
+	}
+
+	// replays start their clock where the capture started
+	const uint16_t beat = g_config.Beat;
+	const uint64_t start_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	fwrite(&CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC), 1, file);
+	fwrite(&CAPTURE_VERSION, sizeof(CAPTURE_VERSION), 1, file);
+	fwrite(&beat, sizeof(beat), 1, file);
+	fwrite(&seed, sizeof(seed), 1, file);
+	fwrite(&start_time, sizeof(start_time), 1, file);
+	return true;
+}
+
+void Capture::close()
+{
+	std::lock_guard<std::mutex> lockClass(mutex);
+
+	if (!file) {
+		return;
+	}
+
+	fclose(file);
+	file = nullptr;
+
+	fmt::printf(">> Captured %d records.\n", records);
+}
+
+void Capture::addLogin(const Connection& connection, uint32_t user_id)
+{
+	if (!file) {
+		return;
+	}
+
+	writeRecord(CAPTURE_RECORD_LOGIN, connection.getId(), reinterpret_cast<const uint8_t*>(&user_id), sizeof(user_id));
+}
+
+void Capture::addPacket(const Connection& connection, const NetworkMessage& msg)
+{
+	if (!file) {
+		return;
+	}
+
+	writeRecord(CAPTURE_RECORD_PACKET, connection.getId(), msg.getReadBuffer(), msg.getLength());
+}
+
+void Capture::addClose(const Connection& connection)
+{
+	if (!file) {
+		return;
+	}
+
+	writeRecord(CAPTURE_RECORD_CLOSE, connection.getId(), nullptr, 0);
+}
+
+void Capture::writeRecord(CaptureRecord_t type, uint32_t connection_id, const uint8_t* data, uint16_t size)
+{
+	const uint32_t beat = g_game.getBeatNr();
+
+	std::lock_guard<std::mutex> lockClass(mutex);
+
+	if (!file) {
+		return;
+	}
+
+	fwrite(&type, sizeof(type), 1, file);
+	fwrite(&beat, sizeof(beat), 1, file);
+	fwrite(&connection_id, sizeof(connection_id), 1, file);
+	fwrite(&size, sizeof(size), 1, file);
+	if (size != 0) {
+		fwrite(data, 1, size, file);
+	}
+
+	records++;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+class Connection;
+class NetworkMessage;
+
+static constexpr uint32_t CAPTURE_MAGIC = 0x50414352; // "RCAP"
+static constexpr uint16_t CAPTURE_VERSION = 1;
+
+enum CaptureRecord_t : uint8_t
+{
+	CAPTURE_RECORD_LOGIN,
+	CAPTURE_RECORD_PACKET,
+	CAPTURE_RECORD_CLOSE,
+};
+
+// Records the inbound traffic of a running server so it can be fed back by Replay.
+// The file starts with magic, version, beat length, random seed and start time, followed by records of
+// type, beat number and connection id; logins carry the user id, packets the decrypted body.
+class Capture
+{
+public:
+	explicit Capture() = default;
+	~Capture();
+
+	Capture(const Capture&) = delete;
+	Capture& operator=(const Capture&) = delete;
+
+	bool open(const std::string& filename, uint32_t seed);
+	void close();
+
+	bool isEnabled() const {
+		return file != nullptr;
+	}
+
+	void addLogin(const Connection& connection, uint32_t user_id);
+	void addPacket(const Connection& connection, const NetworkMessage& msg);
+	void addClose(const Connection& connection);
+private:
+	void writeRecord(CaptureRecord_t type, uint32_t connection_id, const uint8_t* data, uint16_t size);
+
+	FILE* file = nullptr;
+	uint64_t records = 0;
+
+	// connections close on the I/O threads
+	std::mutex mutex;
+};
+
+extern Capture g_capture;
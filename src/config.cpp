@@ -5,6 +5,30 @@
 #include "object.h"
 #include "game.h"
 
+std::array<uint16_t, 256> Config::getDefaultCommandCosts()
+{
+	std::array<uint16_t, 256> costs;
+	costs.fill(1);
+
+	// logout must always get through
+	costs[20] = 0;
+
+	// commands that search paths, walk containers or scan the map cost more than a step
+	costs[100] = 4; // go path
+	costs[120] = 2; // move object
+	costs[130] = 2; // use object
+	costs[131] = 3; // use two objects
+	costs[132] = 3; // use on creature
+	costs[140] = 3; // look at point
+	costs[150] = 2; // talk
+	costs[151] = 2; // request channels
+	costs[201] = 4; // refresh tile
+	costs[210] = 2; // request outfits
+	costs[230] = 10; // bug report
+	costs[232] = 10; // error file entry
+	return costs;
+}
+
 bool Config::loadConfig()
 {
 	ScriptReader script;
@@ -26,6 +50,10 @@ bool Config::loadConfig()
 				Beat = script.readNumber();
 			} else if (identifier == "world") {
 				World = script.readString();
+			} else if (identifier == "mapname") {
+				MapName = script.readString();
+			} else if (identifier == "maxplayers") {
+				MaxPlayers = script.readNumber();
 			} else if (identifier == "sectorxmin") {
 				SectorXMin = script.readNumber();
 			} else if (identifier == "sectorxmax") {
@@ -64,6 +92,69 @@ bool Config::loadConfig()
 				g_game.map_points[name] = pos;
 			} else if (identifier == "itemcount") {
 				ItemCount = script.readNumber();
+			} else if (identifier == "iothreads") {
+				IOThreads = script.readNumber();
+			} else if (identifier == "reuseport") {
+				ReusePort = script.readNumber() != 0;
+			} else if (identifier == "maxconnectionsperip") {
+				MaxConnectionsPerIP = script.readNumber();
+			} else if (identifier == "acceptrateperip") {
+				AcceptRatePerIP = script.readNumber();
+			} else if (identifier == "workerthreads") {
+				WorkerThreads = script.readNumber();
+			} else if (identifier == "characterlist") {
+				CharacterList = script.readNumber() != 0;
+			} else if (identifier == "loginsperbeat") {
+				LoginsPerBeat = script.readNumber();
+			} else if (identifier == "loginqueuesize") {
+				LoginQueueSize = script.readNumber();
+			} else if (identifier == "commandrate") {
+				CommandRate = script.readNumber();
+			} else if (identifier == "commandburst") {
+				CommandBurst = script.readNumber();
+			} else if (identifier == "commandcost") {
+				script.readSymbol('(');
+				const int32_t command = script.readNumber();
+				script.readSymbol(',');
+				const int32_t cost = script.readNumber();
+				script.readSymbol(')');
+
+				if (command < 0 || command >= static_cast<int32_t>(CommandCost.size())) {
+					script.error("invalid command");
+					return false;
+				}
+
+				CommandCost[command] = cost;
+			} else if (identifier == "movementbudget") {
+				MovementBudget = script.readNumber();
+			} else if (identifier == "chatbudget") {
+				ChatBudget = script.readNumber();
+			} else if (identifier == "cosmeticbudget") {
+				CosmeticBudget = script.readNumber();
+			} else if (identifier == "slowconsumerpolicy") {
+				const std::string policy = script.readString();
+				if (policy == "warn") {
+					SlowConsumerPolicy = SLOW_CONSUMER_WARN;
+				} else if (policy == "shed") {
+					SlowConsumerPolicy = SLOW_CONSUMER_SHED;
+				} else if (policy == "disconnect") {
+					SlowConsumerPolicy = SLOW_CONSUMER_DISCONNECT;
+				} else {
+					script.error("unknown slow consumer policy");
+					return false;
+				}
+			} else if (identifier == "slowconsumerbytes") {
+				SlowConsumerBytes = script.readNumber();
+			} else if (identifier == "slowconsumerage") {
+				SlowConsumerAge = script.readNumber();
+			} else if (identifier == "slowconsumerlimit") {
+				SlowConsumerLimit = script.readNumber();
+			} else if (identifier == "capturefile") {
+				CaptureFile = script.readString();
+			} else if (identifier == "statsinterval") {
+				StatsInterval = script.readNumber();
+			} else if (identifier == "statsfile") {
+				StatsFile = script.readString();
 			} else {
 				script.error("unknown identifier");
 				return false;
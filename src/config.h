@@ -1,10 +1,22 @@
 #pragma once
 
+// what happens to a connection whose unsent data crosses SlowConsumerBytes or SlowConsumerAge
+enum SlowConsumerPolicy_t : uint8_t
+{
+	SLOW_CONSUMER_WARN,
+	SLOW_CONSUMER_SHED,
+	SLOW_CONSUMER_DISCONNECT,
+
+	SLOW_CONSUMER_COUNT,
+};
+
 class Config
 {
 public:
 	std::string IP;
 	std::string World;
+	std::string MapName = "RealOTS";
+	uint16_t MaxPlayers = 900;
 	uint16_t Port = 0;
 	uint16_t Beat = 0;
 	int32_t SectorXMin = 0;
@@ -14,8 +26,31 @@ public:
 	int32_t SectorZMin = 0;
 	int32_t SectorZMax = 0;
 	int32_t ItemCount = 0;
+	uint16_t IOThreads = 1;
+	bool ReusePort = false;
+	uint16_t MaxConnectionsPerIP = 10;
+	uint16_t AcceptRatePerIP = 5;
+	uint16_t WorkerThreads = 2;
+	bool CharacterList = true;
+	uint16_t LoginsPerBeat = 10;
+	uint16_t LoginQueueSize = 500;
+	uint16_t CommandRate = 30;
+	uint16_t CommandBurst = 60;
+	std::array<uint16_t, 256> CommandCost = getDefaultCommandCosts();
+	uint32_t MovementBudget = 0;
+	uint32_t ChatBudget = 65536;
+	uint32_t CosmeticBudget = 16384;
+	SlowConsumerPolicy_t SlowConsumerPolicy = SLOW_CONSUMER_SHED;
+	uint32_t SlowConsumerBytes = 262144;
+	uint32_t SlowConsumerAge = 10000;
+	uint32_t SlowConsumerLimit = 4194304;
+	std::string CaptureFile;
+	uint16_t StatsInterval = 0;
+	std::string StatsFile = "stats.log";
 
 	bool loadConfig();
+private:
+	static std::array<uint16_t, 256> getDefaultCommandCosts();
 };
 
 extern Config g_config;
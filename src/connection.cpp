@@ -4,6 +4,20 @@
 #include "protocol.h"
 #include "game.h"
 #include "player.h"
+#include "loginqueue.h"
+#include "config.h"
+#include "capture.h"
+#include "timingwheel.h"
+#include "telemetry.h"
+#include "server.h"
+#include "status.h"
+
+std::atomic<uint32_t> Connection::connection_counter{ 0 };
+
+static int64_t getMilliseconds()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 Connection::~Connection()
 {
@@ -12,14 +26,17 @@ Connection::~Connection()
 
 void Connection::receiveData()
 {
+	// frames already buffered are handed over before asking the socket for more
+	if (!parseBuffer()) {
+		return;
+	}
+
 	try {
-		read_timer.expires_from_now(boost::posix_time::seconds(CONNECTION_READ_TIMEOUT));
-		read_timer.async_wait(std::bind(&Connection::handleTimeout, std::weak_ptr<Connection>(shared_from_this()), std::placeholders::_1));
+		read_deadline = TimingWheel::getTick() + CONNECTION_READ_TIMEOUT;
 
-		// Read size of the first packet
-		boost::asio::async_read(socket,
-			boost::asio::buffer(in_message.getBuffer(), NetworkMessage::HEADER_LENGTH),
-			std::bind(&Connection::parseHeader, shared_from_this(), std::placeholders::_1));
+		// read whatever arrived, one receive usually carries several client packets
+		socket.async_read_some(boost::asio::buffer(in_buffer.data() + in_buffer_length, in_buffer.size() - in_buffer_length),
+			std::bind(&Connection::parseReceive, shared_from_this(), std::placeholders::_1, std::placeholders::_2));
 	} catch (boost::system::system_error& e) {
 		fmt::printf("ERROR - Connection::receiveData: %s.\n", e.what());
 		close();
@@ -28,109 +45,298 @@ void Connection::receiveData()
 
 void Connection::close(bool force)
 {
+	std::lock_guard<std::recursive_mutex> lockClass(mutex_lock);
+
 	if (state != CONNECTION_STATE_OPEN) {
 		return;
 	}
 
 	state = CONNECTION_STATE_CLOSED;
+	g_capture.addClose(*this);
 
-	if (message_queue.empty() || force) {
+	if ((message_queue.empty() && out_messages.empty() && !write_pending) || force) {
 		closeSocket();
 	}
 }
 
-void Connection::send(NetworkMessage& smsg)
+void Connection::send(NetworkMessage&& smsg, MessageClass_t type)
 {
-	if (state != CONNECTION_STATE_OPEN) {
+	if (state != CONNECTION_STATE_OPEN || !admitMessage(smsg, type)) {
 		return;
 	}
 
-	message_queue.emplace_back(smsg);
+	if (smsg.getLength() != 0) {
+		g_telemetry.addSent(smsg.getBodyBuffer()[0], smsg.getLength());
+	}
+
+	queued_bytes += smsg.getLength();
+	message_queue.emplace_back(std::move(smsg));
 }
 
-void Connection::checkCreatureID(uint32_t creature_id, bool& is_known, uint32_t& removed_id)
+void Connection::replayData(NetworkMessage&& msg)
 {
-	const auto result = known_creatures.insert(creature_id);
-	if (!result.second) {
-		is_known = true;
+	if (in_messages.full()) {
+		parseData();
+	}
+
+	in_messages.push(std::move(msg));
+	publishData();
+}
+
+void Connection::sendShared(const NetworkMessage& smsg, MessageClass_t type)
+{
+	if (state != CONNECTION_STATE_OPEN || !admitMessage(smsg, type)) {
 		return;
 	}
 
-	is_known = false;
+	if (smsg.getLength() != 0) {
+		g_telemetry.addSent(smsg.getBodyBuffer()[0], smsg.getLength());
+	}
 
-	if (known_creatures.size() > 150) {
-		// Look for a creature to remove
-		for (auto it = known_creatures.begin(), end = known_creatures.end(); it != end; ++it) {
-			Creature* creature = g_game.getCreatureById(creature_id);
-			if (!player->canSeeCreature(creature)) {
-				removed_id = *it;
-				known_creatures.erase(it);
-				return;
-			}
-		}
+	queued_bytes += smsg.getLength();
 
-		// Bad situation. Let's just remove anyone.
-		auto it = known_creatures.begin();
-		if (*it == creature_id) {
-			++it;
-		}
+	// the bytes end up packed into one frame anyway, append to the last queued message when it has room
+	if (!message_queue.empty() && message_queue.back().appendMessage(smsg)) {
+		return;
+	}
+
+	NetworkMessage msg(MessagePool::getSizeClass(smsg.getLength() + NetworkMessage::HEADER_LENGTH * 2 + NetworkMessage::XTEA_MULTIPLE));
+	msg.appendMessage(smsg);
+	message_queue.emplace_back(std::move(msg));
+}
 
-		removed_id = *it;
-		known_creatures.erase(it);
+bool Connection::admitMessage(const NetworkMessage& smsg, MessageClass_t type)
+{
+	uint32_t budget = 0;
+	switch (type) {
+		case MESSAGE_CLASS_MOVEMENT: budget = g_config.MovementBudget; break;
+		case MESSAGE_CLASS_CHAT: budget = g_config.ChatBudget; break;
+		case MESSAGE_CLASS_COSMETIC: budget = g_config.CosmeticBudget; break;
+		default: break;
+	}
+
+	// a slow consumer under the shed policy gets no chat or effects until it caught up
+	const bool shed_class = slow_consumer && g_config.SlowConsumerPolicy == SLOW_CONSUMER_SHED && type >= MESSAGE_CLASS_CHAT;
+
+	// critical messages and classes without a budget always go out, congestion is judged on what was
+	// handed off but not written yet; the bytes queued this beat include the map description and such
+	if (!shed_class && (budget == 0 || unsent_bytes + smsg.getLength() <= budget)) {
+		return true;
+	}
+
+	// reported and reset once a second by checkBandwidth
+	shed_messages++;
+
+	if (smsg.getLength() != 0) {
+		g_telemetry.addShed(smsg.getBodyBuffer()[0], smsg.getLength());
+	}
+	return false;
+}
+
+bool Connection::spendCommandBudget(uint16_t cost)
+{
+	const int64_t now = getMilliseconds();
+	const int64_t burst = static_cast<int64_t>(g_config.CommandBurst) * 1000;
+
+	if (command_budget < 0) {
+		command_budget = burst;
 	} else {
-		removed_id = 0;
+		// CommandRate tokens per second is CommandRate thousandths per millisecond
+		command_budget = std::min<int64_t>(burst, command_budget + (now - command_budget_time) * g_config.CommandRate);
 	}
+	command_budget_time = now;
+
+	// one line when dropping starts and one once the bucket has refilled, not one per burst
+	if (dropped_commands != 0 && command_budget >= burst) {
+		fmt::printf("INFO - Connection::spendCommandBudget: %s is within the command budget again, %d commands were dropped.\n", player ? player->getName() : "unknown", dropped_commands);
+		dropped_commands = 0;
+	}
+
+	if (command_budget < static_cast<int64_t>(cost) * 1000) {
+		if (dropped_commands++ == 0) {
+			fmt::printf("INFO - Connection::spendCommandBudget: %s exceeded the command budget, dropping commands.\n", player ? player->getName() : "unknown");
+		}
+		return false;
+	}
+
+	command_budget -= static_cast<int64_t>(cost) * 1000;
+	return true;
 }
 
-void Connection::parseHeader(const boost::system::error_code& error)
+void Connection::checkBandwidth()
 {
-	read_timer.cancel();
+	if (headless || state != CONNECTION_STATE_OPEN) {
+		return;
+	}
 
-	if (error) {
+	const int64_t now = getMilliseconds();
+
+	uint64_t written = 0;
+	int64_t oldest_time = 0;
+	{
+		std::lock_guard<std::recursive_mutex> lockClass(mutex_lock);
+		written = written_bytes;
+		oldest_time = write_time != 0 ? write_time : out_time;
+	}
+
+	if (check_time != 0 && now > check_time) {
+		write_rate = static_cast<uint32_t>((written - checked_bytes) * 1000 / (now - check_time));
+	}
+	checked_bytes = written;
+	check_time = now;
+
+	const uint32_t unsent = getUnsentBytes();
+	const int64_t age = oldest_time != 0 ? now - oldest_time : 0;
+	const char* name = player ? player->getName().c_str() : "unknown";
+
+	if (shed_messages != 0) {
+		fmt::printf("INFO - Connection::checkBandwidth: %s is not keeping up, shed %d outbound messages.\n", name, shed_messages);
+		shed_messages = 0;
+	}
+
+	// whatever the policy, nobody gets to pin this much memory
+	if (g_config.SlowConsumerLimit != 0 && unsent >= g_config.SlowConsumerLimit) {
+		fmt::printf("INFO - Connection::checkBandwidth: %s holds %d unsent bytes, disconnecting.\n", name, unsent);
+		g_telemetry.addSlowConsumer(SLOW_CONSUMER_DISCONNECT);
 		close();
 		return;
 	}
 
-	if (state != CONNECTION_STATE_OPEN) {
+	const bool behind = (g_config.SlowConsumerBytes != 0 && unsent >= g_config.SlowConsumerBytes) ||
+		(g_config.SlowConsumerAge != 0 && age >= g_config.SlowConsumerAge);
+	if (behind == slow_consumer) {
 		return;
 	}
 
-	const uint32_t time_passed = std::max<uint32_t>(1, (time(nullptr) - time_connected) + 1);
-	if ((++packets_sent / time_passed) > static_cast<uint32_t>(15)) {
-		fmt::printf("INFO - Connection::parseHeader: %s disconnected for exceeding packet per second limit.\n", socket.local_endpoint().address().to_string());
-		close();
+	slow_consumer = behind;
+	if (!behind) {
+		fmt::printf("INFO - Connection::checkBandwidth: %s caught up.\n", name);
 		return;
 	}
 
-	if (time_passed > 2) {
-		time_connected = time(nullptr);
-		packets_sent = 0;
+	fmt::printf("INFO - Connection::checkBandwidth: %s is behind by %d bytes and %d ms, writing %d bytes/s.\n", name, unsent, age, write_rate);
+	g_telemetry.addSlowConsumer(g_config.SlowConsumerPolicy);
+
+	if (g_config.SlowConsumerPolicy == SLOW_CONSUMER_DISCONNECT) {
+		close();
+	}
+}
+
+int64_t Connection::getDeadline() const
+{
+	if (read_deadline == 0 || write_deadline == 0) {
+		return std::max(read_deadline, write_deadline);
 	}
+	return std::min(read_deadline, write_deadline);
+}
+
+void Connection::checkCreatureID(const Creature* creature, bool& is_known, uint32_t& removed_id)
+{
+	is_known = known_creatures.checkCreature(creature, player, removed_id);
+}
+
+void Connection::parseReceive(const boost::system::error_code& error, size_t bytes_transferred)
+{
+	read_deadline = 0;
 
-	const uint16_t size = in_message.getLengthHeader();
-	if (size == 0 || size >= NETWORKMESSAGE_MAXSIZE - 16) {
+	if (error) {
 		close();
 		return;
 	}
 
-	try {
-		read_timer.expires_from_now(boost::posix_time::seconds(CONNECTION_READ_TIMEOUT));
-		read_timer.async_wait(std::bind(&Connection::handleTimeout, std::weak_ptr<Connection>(shared_from_this()),
-			std::placeholders::_1));
+	if (state != CONNECTION_STATE_OPEN) {
+		return;
+	}
 
-		// Read packet content
+	in_buffer_length += bytes_transferred;
+	receiveData();
+}
+
+bool Connection::parseBuffer()
+{
+	size_t offset = 0;
+	bool parsed = false;
+	bool read_more = true;
+
+	while (in_buffer_length - offset >= NetworkMessage::HEADER_LENGTH) {
+		const uint8_t* frame = in_buffer.data() + offset;
+		const uint16_t size = static_cast<uint16_t>(frame[0] | frame[1] << 8);
+		if (size == 0 || size >= NETWORKMESSAGE_MAXSIZE - 16) {
+			close();
+			return false;
+		}
+
+		// stop reading until the game thread makes room again
+		if (in_messages.full()) {
+			read_paused = true;
+			if (in_messages.full() || !read_paused.exchange(false)) {
+				read_more = false;
+				break;
+			}
+		}
+
+		const size_t available = in_buffer_length - offset - NetworkMessage::HEADER_LENGTH;
+		if (available < size && static_cast<size_t>(size + NetworkMessage::HEADER_LENGTH) <= in_buffer.size()) {
+			break;
+		}
+
+		// status queries are answered right here, only real clients are registered with the game
+		if (first_frame) {
+			if (available >= size && Status::isStatusRequest(frame + NetworkMessage::HEADER_LENGTH, size)) {
+				sendStatus();
+				return false;
+			}
+
+			first_frame = false;
+			g_game.addConnection(shared_from_this());
+		}
+
+		in_message = NetworkMessage(MessagePool::getSizeClass(size + NetworkMessage::HEADER_LENGTH + NetworkMessage::XTEA_MULTIPLE));
 		in_message.setLength(size + NetworkMessage::HEADER_LENGTH);
-		boost::asio::async_read(socket, boost::asio::buffer(in_message.getBuffer(), size),
-			std::bind(&Connection::parsePacket, shared_from_this(), std::placeholders::_1));
-	} catch (boost::system::system_error& e) {
-		fmt::printf("ERROR - Connection::parseHeader: %s.\n", e.what());
-		close();
+
+		if (available < size) {
+			// larger than the receive buffer, the rest is read straight into the message
+			memcpy(in_message.getBuffer(), frame + NetworkMessage::HEADER_LENGTH, available);
+			in_buffer_length = 0;
+
+			if (parsed) {
+				publishData();
+			}
+
+			try {
+				read_deadline = TimingWheel::getTick() + CONNECTION_READ_TIMEOUT;
+
+				boost::asio::async_read(socket, boost::asio::buffer(in_message.getBuffer() + available, size - available),
+					std::bind(&Connection::parsePacket, shared_from_this(), std::placeholders::_1));
+			} catch (boost::system::system_error& e) {
+				fmt::printf("ERROR - Connection::parseBuffer: %s.\n", e.what());
+				close();
+			}
+			return false;
+		}
+
+		memcpy(in_message.getBuffer(), frame + NetworkMessage::HEADER_LENGTH, size);
+		in_messages.push(std::move(in_message));
+		offset += size + NetworkMessage::HEADER_LENGTH;
+		parsed = true;
+	}
+
+	// keep the incomplete frame at the front of the buffer
+	if (offset != 0) {
+		in_buffer_length -= offset;
+		memmove(in_buffer.data(), in_buffer.data() + offset, in_buffer_length);
 	}
+
+	if (parsed) {
+		publishData();
+	}
+
+	return read_more;
 }
 
 void Connection::parsePacket(const boost::system::error_code& error)
 {
-	read_timer.cancel();
+	read_deadline = 0;
 
 	if (error) {
 		close();
@@ -141,61 +347,194 @@ void Connection::parsePacket(const boost::system::error_code& error)
 		return;
 	}
 
-	pending_data++;
+	in_messages.push(std::move(in_message));
+	publishData();
+
+	// stop reading until the game thread makes room again
+	if (in_messages.full()) {
+		read_paused = true;
+		if (in_messages.full() || !read_paused.exchange(false)) {
+			return;
+		}
+	}
+
+	receiveData();
+}
+
+void Connection::publishData()
+{
+	// pairs with the fence in Game::receiveData so a packet pushed while the game thread drains is never lost
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (ready.exchange(true)) {
+		return;
+	}
+
+	ready_self = shared_from_this();
+	g_game.addReadyConnection(this);
 }
 
 void Connection::parseData()
 {
-	if (pending_data <= 0) {
+	while (!in_messages.empty()) {
+		if (state == CONNECTION_STATE_OPEN) {
+			parseMessage(in_messages.front());
+		}
+		in_messages.pop();
+	}
+
+	if (read_paused.exchange(false)) {
+		boost::asio::post(socket.get_executor(), std::bind(&Connection::receiveData, shared_from_this()));
+	}
+}
+
+void Connection::sendStatus()
+{
+	std::shared_ptr<const std::string> response = g_status.getResponse();
+	if (!response) {
+		close();
 		return;
 	}
 
-	pending_data--;
+	try {
+		write_deadline = TimingWheel::getTick() + CONNECTION_WRITE_TIMEOUT;
+
+		// the reply is shared by every query of the second, the handler keeps it alive
+		Connection_ptr self = shared_from_this();
+		boost::asio::async_write(socket, boost::asio::buffer(*response), [self, response](const boost::system::error_code&, size_t) {
+			self->write_deadline = 0;
+			self->close();
+		});
+	} catch (boost::system::system_error& e) {
+		fmt::printf("ERROR - Connection::sendStatus: %s.\n", e.what());
+		close();
+	}
+}
 
-	in_message.setPosition(0);
+void Connection::parseMessage(NetworkMessage& msg)
+{
+	msg.setPosition(0);
 
 	if (player) {
-		if (!in_message.xteaDecrypt(symmetric_key)) {
+		if (headless) {
+			msg.setLength(msg.readWord());
+			Protocol::parseCommand(shared_from_this(), msg);
+			return;
+		}
+
+		if (!msg.xteaDecrypt(symmetric_key)) {
 			fmt::printf("INFO - Connection::parseData: %s sent a packet that failed to decrypt with RSA.\n", player->getName());
+		} else {
+			g_capture.addPacket(*this, msg);
 		}
 
-		Protocol::parseCommand(shared_from_this(), in_message);
+		Protocol::parseCommand(shared_from_this(), msg);
 	} else {
-		const uint8_t protocol_type = in_message.readByte();
-		if (protocol_type == 0x01) {
-			Protocol::parseCharacterList(shared_from_this(), in_message);
-		} else if (protocol_type == 0x0A) {
-			Protocol::parseCharacterLogin(shared_from_this(), in_message);
+		const uint8_t protocol_type = msg.readByte();
+		if (protocol_type == 0x01 && !g_config.CharacterList) {
+			// character lists are served by the login gateway, nothing is decrypted for them here
+			close();
+		} else if (protocol_type == 0x01 || protocol_type == 0x0A) {
+			g_loginqueue.addLogin(shared_from_this(), protocol_type, std::move(msg));
 		} else {
 			fmt::printf("INFO - Connection::parseData: unknown protocol %d.\n", protocol_type);
 		}
 	}
-
-	receiveData();
 }
 
 void Connection::sendAll()
 {
 	std::lock_guard<std::recursive_mutex> lockClass(mutex_lock);
 
-	for (NetworkMessage& msg : message_queue) {
-		internalSend(msg);
+	if (message_queue.empty()) {
+		return;
+	}
+
+	// nobody reads a replayed connection, encoding the messages was the work worth measuring
+	if (headless) {
+		message_queue.clear();
+		queued_bytes = 0;
+		return;
 	}
-	message_queue.clear();
+
+	out_bytes += queued_bytes;
+	unsent_bytes += queued_bytes;
+	queued_bytes = 0;
+
+	if (out_time == 0) {
+		out_time = getMilliseconds();
+	}
+
+	// hand the plain messages over, framing and encryption happen on the I/O thread
+	if (out_messages.empty()) {
+		out_messages.swap(message_queue);
+	} else {
+		for (NetworkMessage& msg : message_queue) {
+			out_messages.emplace_back(std::move(msg));
+		}
+		message_queue.clear();
+	}
+
+	if (!flush_pending) {
+		flush_pending = true;
+		boost::asio::post(socket.get_executor(), std::bind(&Connection::flushData, shared_from_this()));
+	}
+}
+
+void Connection::flushData()
+{
+	std::vector<NetworkMessage> messages;
+
+	{
+		std::lock_guard<std::recursive_mutex> lockClass(mutex_lock);
+		flush_pending = false;
+
+		// only one write is in flight at a time, onWriteOperation flushes the rest
+		if (write_pending || out_messages.empty()) {
+			return;
+		}
+
+		// close() must not shut the socket while these messages are framed outside the lock
+		write_pending = true;
+		messages.swap(out_messages);
+		write_bytes = out_bytes;
+		out_bytes = 0;
+		write_time = out_time;
+		out_time = 0;
+	}
+
+	// pack as many messages as fit into a single frame
+	for (NetworkMessage& msg : messages) {
+		if (write_queue.empty() || !write_queue.back().appendMessage(msg)) {
+			write_queue.emplace_back(std::move(msg));
+		}
+	}
+
+	internalSend();
 }
 
 void Connection::onWriteOperation(const boost::system::error_code& error)
 {
 	std::lock_guard<std::recursive_mutex> lockClass(mutex_lock);
 
-	write_timer.cancel();
+	write_deadline = 0;
+	write_queue.clear();
+	write_pending = false;
+	unsent_bytes -= write_bytes;
+	written_bytes += write_bytes;
+	write_bytes = 0;
+	write_time = 0;
 
 	if (error) {
-		message_queue.clear();
+		out_messages.clear();
 		close();
 		return;
 	}
 
+	if (!out_messages.empty()) {
+		flushData();
+		return;
+	}
+
 	if (state == CONNECTION_STATE_CLOSED) {
 		closeSocket();
 	}
@@ -203,16 +542,22 @@ void Connection::onWriteOperation(const boost::system::error_code& error)
 
 void Connection::closeSocket()
 {
+	std::lock_guard<std::recursive_mutex> lockClass(mutex_lock);
+
+	if (player) {
+		player->setConnection(nullptr);
+		player = nullptr;
+	}
+
+	if (address != 0) {
+		g_server.releaseAddress(address);
+		address = 0;
+	}
+
 	if (socket.is_open()) {
 		try {
-			if (player) {
-				player->setConnection(nullptr);
-				player = nullptr;
-			}
-
 			message_queue.clear();
-			read_timer.cancel();
-			write_timer.cancel();
+			out_messages.clear();
 			boost::system::error_code error;
 			socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
 			socket.close(error);
@@ -222,37 +567,80 @@ void Connection::closeSocket()
 	}
 }
 
-void Connection::internalSend(NetworkMessage& msg)
+void Connection::reset()
 {
-	std::lock_guard<std::recursive_mutex> lockClass(mutex_lock);
-
-	// prepare packet
-	msg.writeHeader();
-	msg.xteaEncrypt(symmetric_key);
-	msg.writeHeader();
+	closeSocket();
 
-	try {
-		write_timer.expires_from_now(boost::posix_time::seconds(CONNECTION_WRITE_TIMEOUT));
-		write_timer.async_wait(std::bind(&Connection::handleTimeout, std::weak_ptr<Connection>(shared_from_this()),
-			std::placeholders::_1));
+	id = ++connection_counter;
+	state = CONNECTION_STATE_OPEN;
 
-		boost::asio::async_write(socket,
-			boost::asio::buffer(msg.getBuffer(), msg.getLength()),
-			std::bind(&Connection::onWriteOperation, shared_from_this(), std::placeholders::_1));
-	} catch (boost::system::system_error& e) {
-		fmt::printf("ERROR - Connection::internalSend: %s.\n", e.what());
-		close();
+	in_buffer_length = 0;
+	first_frame = true;
+	in_message = NetworkMessage();
+	while (!in_messages.empty()) {
+		in_messages.pop();
 	}
+	read_paused = false;
+
+	ready = false;
+	next_ready = nullptr;
+
+	known_creatures.clear();
+	message_queue.clear();
+	queued_bytes = 0;
+	shed_messages = 0;
+
+	out_messages.clear();
+	out_bytes = 0;
+	flush_pending = false;
+
+	write_queue.clear();
+	write_pending = false;
+	write_bytes = 0;
+	unsent_bytes = 0;
+	out_time = 0;
+	write_time = 0;
+	written_bytes = 0;
+
+	checked_bytes = 0;
+	check_time = 0;
+	write_rate = 0;
+	slow_consumer = false;
+
+	read_deadline = 0;
+	write_deadline = 0;
+
+	command_budget = -1;
+	command_budget_time = 0;
+	dropped_commands = 0;
+
+	memset(symmetric_key, 0, sizeof(symmetric_key));
 }
 
-void Connection::handleTimeout(ConnectionWeak_ptr connection_weak, const boost::system::error_code& error)
+void Connection::internalSend()
 {
-	if (error == boost::asio::error::operation_aborted) {
-		//The timer has been manually cancelled
-		return;
+	std::vector<boost::asio::const_buffer> buffers;
+	buffers.reserve(write_queue.size());
+
+	// prepare frames
+	for (NetworkMessage& frame : write_queue) {
+		frame.writeHeader();
+		frame.xteaEncrypt(symmetric_key);
+		frame.writeHeader();
+		buffers.emplace_back(frame.getBuffer(), frame.getLength());
 	}
 
-	if (auto Connection = connection_weak.lock()) {
-		Connection->close();
+	std::lock_guard<std::recursive_mutex> lockClass(mutex_lock);
+
+	try {
+		write_deadline = TimingWheel::getTick() + CONNECTION_WRITE_TIMEOUT;
+
+		boost::asio::async_write(socket, buffers,
+			std::bind(&Connection::onWriteOperation, shared_from_this(), std::placeholders::_1));
+	} catch (boost::system::system_error& e) {
+		fmt::printf("ERROR - Connection::internalSend: %s.\n", e.what());
+		write_queue.clear();
+		write_pending = false;
+		close();
 	}
 }
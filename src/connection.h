@@ -1,13 +1,16 @@
 #pragma once
 
 #include "networkmessage.h"
-
-#include <unordered_set>
+#include "ringbuffer.h"
+#include "knowncreatures.h"
 
 static constexpr int32_t CONNECTION_WRITE_TIMEOUT = 30;
 static constexpr int32_t CONNECTION_READ_TIMEOUT = 30;
+static constexpr size_t CONNECTION_INBOUND_CAPACITY = 16;
+static constexpr size_t CONNECTION_RECEIVE_BUFFER = 4096;
 
 class Game;
+class Creature;
 class Player;
 class Server;
 class Connection;
@@ -21,13 +24,23 @@ enum ConnectionState_t
 	CONNECTION_STATE_CLOSED,
 };
 
+// outbound messages are shed from the last class upwards while a connection is congested
+enum MessageClass_t : uint8_t
+{
+	MESSAGE_CLASS_CRITICAL,
+	MESSAGE_CLASS_MOVEMENT,
+	MESSAGE_CLASS_CHAT,
+	MESSAGE_CLASS_COSMETIC,
+};
+
 class Connection : public std::enable_shared_from_this<Connection>
 {
 public:
-	explicit Connection(boost::asio::io_service& io_service) :
-		read_timer(io_service),
-		write_timer(io_service),
-		socket(io_service) {
+	// headless connections have no socket, they are fed decrypted packets by the replay harness
+	explicit Connection(boost::asio::io_service& io_service, bool headless = false) :
+		socket(io_service),
+		id(++connection_counter),
+		headless(headless) {
 		//
 	}
 	~Connection();
@@ -36,7 +49,11 @@ public:
 	void close(bool force = true);
 	void closeSocket();
 
-	void send(NetworkMessage& smsg);
+	void send(NetworkMessage&& smsg, MessageClass_t type = MESSAGE_CLASS_CRITICAL);
+	// queues a packet of the replay harness, the body is read as already decrypted
+	void replayData(NetworkMessage&& msg);
+	// copies an encoded message into the outbound queue, used when many connections get the same bytes
+	void sendShared(const NetworkMessage& smsg, MessageClass_t type = MESSAGE_CLASS_CRITICAL);
 
 	Player* getPlayer() const {
 		return player;
@@ -48,6 +65,17 @@ public:
 	ConnectionState_t getState() const {
 		return state;
 	}
+	uint32_t getId() const {
+		return id;
+	}
+
+	// remote IPv4 address counted against the per address limits of Server, 0 if not counted
+	void setAddress(uint32_t new_address) {
+		address = new_address;
+	}
+	uint32_t getAddress() const {
+		return address;
+	}
 
 	boost::asio::ip::tcp::socket& getSocket() {
 		return socket;
@@ -56,39 +84,114 @@ public:
 	void setSymmetricKey(uint32_t* key) {
 		memcpy(symmetric_key, key, sizeof(uint32_t) * 4);
 	}
-	void checkCreatureID(uint32_t creature_id, bool& is_known, uint32_t& removed_id);
+	void checkCreatureID(const Creature* creature, bool& is_known, uint32_t& removed_id);
+
+	// earliest pending read or write deadline in TimingWheel ticks, 0 if there is none
+	int64_t getDeadline() const;
+
+	// token bucket refilled at g_config.CommandRate per second, false if the command has to be dropped
+	bool spendCommandBudget(uint16_t cost);
+
+	// body bytes queued this beat or handed to the I/O thread and not yet written
+	uint32_t getUnsentBytes() const {
+		return queued_bytes + unsent_bytes;
+	}
+	// bytes written per second as of the last checkBandwidth
+	uint32_t getWriteRate() const {
+		return write_rate;
+	}
+	// updates the write rate and applies g_config.SlowConsumerPolicy, once per second from the game thread
+	void checkBandwidth();
 private:
 
-	void parseHeader(const boost::system::error_code& error);
+	void parseReceive(const boost::system::error_code& error, size_t bytes_transferred);
+	bool parseBuffer();
 	void parsePacket(const boost::system::error_code& error);
 	void parseData();
+	void parseMessage(NetworkMessage& msg);
+	void publishData();
+
+	// answers a status query from the snapshot of g_status and closes, never touches the game thread
+	void sendStatus();
+
+	// false if the client is too far behind to be sent a message of this class
+	bool admitMessage(const NetworkMessage& smsg, MessageClass_t type);
 
 	void sendAll();
+	void flushData();
 
-	void internalSend(NetworkMessage& msg);
-	void onWriteOperation(const boost::system::error_code& error);
+	// puts a released connection back into the state of a freshly constructed one
+	void reset();
 
-	static void handleTimeout(ConnectionWeak_ptr connection_weak, const boost::system::error_code& error);
+	void internalSend();
+	void onWriteOperation(const boost::system::error_code& error);
 
 	Player* player = nullptr;
 
+	// filled by the I/O thread, drained by the game thread
+	std::array<uint8_t, CONNECTION_RECEIVE_BUFFER> in_buffer;
+	size_t in_buffer_length = 0;
+	bool first_frame = true;
 	NetworkMessage in_message{};
-	int32_t pending_data = 0;
-
-	std::unordered_set<uint32_t> known_creatures{};
-	std::list<NetworkMessage> message_queue{};
+	RingBuffer<NetworkMessage, CONNECTION_INBOUND_CAPACITY> in_messages{};
+	std::atomic<bool> read_paused{ false };
+
+	// link in Game's ready list, the connection keeps itself alive while listed
+	std::atomic<bool> ready{ false };
+	Connection* next_ready = nullptr;
+	Connection_ptr ready_self{};
+
+	KnownCreatures known_creatures;
+	std::vector<NetworkMessage> message_queue{};
+	uint32_t queued_bytes = 0;
+	uint32_t shed_messages = 0;
+
+	// handed over by the game thread, waiting to be framed on the I/O thread
+	std::vector<NetworkMessage> out_messages{};
+	uint32_t out_bytes = 0;
+	bool flush_pending = false;
+
+	// encrypted frames of the write in flight, only touched by the I/O thread; write_pending is
+	// guarded by mutex_lock and tells close() that a write is being framed or is in flight
+	std::vector<NetworkMessage> write_queue{};
+	bool write_pending = false;
+	uint32_t write_bytes = 0;
+
+	// body bytes handed over to the I/O thread and not yet written to the socket
+	std::atomic<uint32_t> unsent_bytes{ 0 };
+
+	// steady clock milliseconds of the oldest message in out_messages and in the write in flight, 0 if none
+	int64_t out_time = 0;
+	int64_t write_time = 0;
+	uint64_t written_bytes = 0;
+
+	// write rate bookkeeping of checkBandwidth, only touched by the game thread
+	uint64_t checked_bytes = 0;
+	int64_t check_time = 0;
+	uint32_t write_rate = 0;
+	bool slow_consumer = false;
 	std::recursive_mutex mutex_lock;
 
-	boost::asio::deadline_timer read_timer;
-	boost::asio::deadline_timer write_timer;
 	boost::asio::ip::tcp::socket socket;
 
-	time_t time_connected = time(nullptr);
+	// TimingWheel ticks, 0 while no read or write is pending, only touched by the I/O thread
+	int64_t read_deadline = 0;
+	int64_t write_deadline = 0;
+
+	static std::atomic<uint32_t> connection_counter;
+	uint32_t id;
+	uint32_t address = 0;
+	const bool headless;
+
+	// command budget in thousandths of a token, only touched by the game thread
+	int64_t command_budget = -1;
+	int64_t command_budget_time = 0;
+	uint32_t dropped_commands = 0;
 
-	uint32_t packets_sent = 0;
 	uint32_t symmetric_key[4]{};
 
 	ConnectionState_t state = CONNECTION_STATE_OPEN;
 
 	friend class Game;
+	friend class ConnectionPool;
 };
\ No newline at end of file
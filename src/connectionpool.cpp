@@ -0,0 +1,96 @@
+#include "pch.h"
+
+#include "connectionpool.h"
+
+ConnectionPool::~ConnectionPool()
+{
+	shutdown();
+
+	for (void* block : free_blocks) {
+		::operator delete(block);
+	}
+	free_blocks.clear();
+}
+
+Connection_ptr ConnectionPool::acquireConnection()
+{
+	Connection* connection = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+		if (!free_connections.empty()) {
+			connection = free_connections.back();
+			free_connections.pop_back();
+		}
+	}
+
+	if (connection) {
+		hits++;
+	} else {
+		misses++;
+		connection = new Connection(io_service);
+	}
+
+	return Connection_ptr(connection, Deleter{ this }, BlockAllocator<Connection>(this));
+}
+
+void ConnectionPool::shutdown()
+{
+	std::vector<Connection*> connections;
+
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+		closed = true;
+		connections.swap(free_connections);
+	}
+
+	for (Connection* connection : connections) {
+		delete connection;
+	}
+}
+
+void ConnectionPool::releaseConnection(Connection* connection)
+{
+	connection->reset();
+
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+		if (!closed && free_connections.size() < CONNECTION_POOL_LIMIT) {
+			free_connections.push_back(connection);
+			return;
+		}
+	}
+
+	delete connection;
+}
+
+void* ConnectionPool::acquireBlock(size_t size)
+{
+	if (size > CONNECTION_POOL_BLOCK_SIZE) {
+		return ::operator new(size);
+	}
+
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+		if (!free_blocks.empty()) {
+			void* block = free_blocks.back();
+			free_blocks.pop_back();
+			return block;
+		}
+	}
+
+	return ::operator new(CONNECTION_POOL_BLOCK_SIZE);
+}
+
+void ConnectionPool::releaseBlock(void* block, size_t size)
+{
+	if (size <= CONNECTION_POOL_BLOCK_SIZE) {
+		std::lock_guard<std::mutex> lockClass(mutex);
+		if (free_blocks.size() < CONNECTION_POOL_LIMIT) {
+			free_blocks.push_back(block);
+			return;
+		}
+	}
+
+	::operator delete(block);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "connection.h"
+
+// connections kept around per io_service once released, anything above is returned to the system
+static constexpr size_t CONNECTION_POOL_LIMIT = 1024;
+static constexpr size_t CONNECTION_POOL_BLOCK_SIZE = 128;
+
+// Recycles the connections of one io_service, a socket stays bound to the service it was created for.
+// Released connections are reset and handed out again by the next accept, the shared_ptr control
+// blocks are recycled as well so accepting does not allocate once the pool is warm.
+// Owned by the Server, which shuts it down after the I/O threads joined and destroys it last.
+class ConnectionPool
+{
+public:
+	explicit ConnectionPool(boost::asio::io_service& io_service) :
+		io_service(io_service) {
+		//
+	}
+	~ConnectionPool();
+
+	ConnectionPool(const ConnectionPool&) = delete;
+	ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+	Connection_ptr acquireConnection();
+	// deletes the idle connections while their io_service still exists, later releases delete directly
+	void shutdown();
+
+	uint64_t getHits() const {
+		return hits;
+	}
+	uint64_t getMisses() const {
+		return misses;
+	}
+private:
+	// plain pool pointers, the Server destroys its pools only once no connection is left
+	struct Deleter
+	{
+		void operator()(Connection* connection) const {
+			pool->releaseConnection(connection);
+		}
+
+		ConnectionPool* pool;
+	};
+
+	template<typename T>
+	struct BlockAllocator
+	{
+		using value_type = T;
+
+		explicit BlockAllocator(ConnectionPool* pool) :
+			pool(pool) {
+			//
+		}
+		template<typename U>
+		BlockAllocator(const BlockAllocator<U>& other) :
+			pool(other.pool) {
+			//
+		}
+
+		T* allocate(size_t n) {
+			return static_cast<T*>(pool->acquireBlock(n * sizeof(T)));
+		}
+		void deallocate(T* block, size_t n) {
+			pool->releaseBlock(block, n * sizeof(T));
+		}
+
+		template<typename U>
+		bool operator==(const BlockAllocator<U>& other) const {
+			return pool == other.pool;
+		}
+		template<typename U>
+		bool operator!=(const BlockAllocator<U>& other) const {
+			return pool != other.pool;
+		}
+
+		ConnectionPool* pool;
+	};
+
+	void releaseConnection(Connection* connection);
+
+	void* acquireBlock(size_t size);
+	void releaseBlock(void* block, size_t size);
+
+	boost::asio::io_service& io_service;
+
+	// connections are released by whichever thread drops the last reference
+	std::mutex mutex;
+	std::vector<Connection*> free_connections;
+	std::vector<void*> free_blocks;
+	bool closed = false;
+
+	std::atomic<uint64_t> hits{ 0 };
+	std::atomic<uint64_t> misses{ 0 };
+};
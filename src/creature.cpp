@@ -724,7 +724,7 @@ void Creature::toDoUseTwoObjects(const Position& pos, uint16_t type_id, uint8_t
 	todo_list[total_todo++] = entry;
 }
 
-void Creature::toDoTalk(const std::string& text, const std::string& address, uint16_t channel_id, TalkType_t type, bool check_spamming)
+void Creature::toDoTalk(std::string_view text, std::string_view address, uint16_t channel_id, TalkType_t type, bool check_spamming)
 {
 	if (lock_todo && toDoClear() && creature_type == CREATURE_PLAYER) {
 		Protocol::sendSnapback(connection_ptr);
@@ -737,7 +737,7 @@ void Creature::toDoTalk(const std::string& text, const std::string& address, uin
 	entry.channel_id = channel_id;
 	entry.check_spamming = check_spamming;
 	entry.type = type;
-	todo_list[total_todo++] = entry;
+	todo_list[total_todo++] = std::move(entry);
 }
 
 void Creature::toDoAdd(ToDoEntry& new_entry)
@@ -859,7 +859,7 @@ void Creature::execute()
 
 void Creature::setId()
 {
-	static uint32_t next_creature_id = 0x40000000;
+	static std::atomic<uint32_t> next_creature_id{ 0x40000000 };
 	id = next_creature_id++;
 }
 
@@ -71,6 +71,12 @@ public:
 	}
 
 	virtual void setTiming(int32_t new_cycle, int32_t new_count, int32_t new_max_count, int32_t additional_value);
+	// timing read from a user file, the skill check is added once the creature is on the game thread
+	void loadTiming(int32_t new_cycle, int32_t new_count, int32_t new_max_count) {
+		cycle = new_cycle;
+		count = new_count;
+		max_count = new_max_count;
+	}
 	virtual bool process();
 protected:
 	virtual void event(int32_t) {
@@ -129,6 +135,10 @@ public:
 
 	void setTiming(int32_t new_cycle, int32_t new_count, int32_t new_max_count, int32_t additional_value) final;
 	void setBaseSpeed(int32_t value);
+	// speed read from a user file, nobody sees the creature yet
+	void loadBaseSpeed(int32_t value) {
+		speed = value;
+	}
 	void setDelta(int32_t value);
 protected:
 	void event(int32_t value) final;
@@ -327,7 +337,7 @@ public:
 	void toDoUseTwoObjects(const Position& pos, uint16_t type_id, uint8_t index, uint32_t creature_id);
 	void toDoUseTwoObjects(Item* item, const Position& to_pos, uint16_t to_type_id, uint8_t to_index);
 	void toDoUseTwoObjects(const Position& pos, uint16_t type_id, uint8_t index, const Position& to_pos, uint16_t to_type_id, uint8_t to_index);
-	void toDoTalk(const std::string& text, const std::string& address, uint16_t channel_id, TalkType_t type, bool check_spamming);
+	void toDoTalk(std::string_view text, std::string_view address, uint16_t channel_id, TalkType_t type, bool check_spamming);
 	void toDoAdd(ToDoEntry& new_entry);
 	void toDoStop();
 	void toDoStart();
@@ -358,6 +368,7 @@ protected:
 	bool removed = false;
 	bool is_dead = false;
 	bool skill_processing = false;
+	uint8_t changed_types = 0;
 	bool secure_mode = false;
 	bool following = false;
 	bool stop = false;
@@ -15,6 +15,9 @@
 #include "party.h"
 #include "vocation.h"
 #include "itempool.h"
+#include "loginqueue.h"
+#include "telemetry.h"
+#include "status.h"
 
 uint64_t getSystemMilliseconds()
 {
@@ -42,25 +45,39 @@ void Game::launchGame()
 
 	fmt::print(">> Game-server is running (Pid={0})\n", std::this_thread::get_id());
 
-	currentBeatMiliseconds = getSystemMilliseconds();
+	resetClock(getSystemMilliseconds());
 	while (game_state >= GAME_RUNNING) {
 		clock::time_point next_time_point = clock::now() + std::chrono::milliseconds(g_config.Beat);
 
-		const int64_t systemMillisecondsNow = getSystemMilliseconds();
-		const int64_t delay = systemMillisecondsNow - serverMilliseconds();
-		currentBeatMiliseconds = systemMillisecondsNow;
+		runBeat(getSystemMilliseconds());
 
-		// read data from connections
-		receiveData();
+		std::this_thread::sleep_until(next_time_point);
+	}
+}
 
-		// move game
-		advanceGame(delay);
+void Game::runBeat(uint64_t milliseconds)
+{
+	const auto start_time = std::chrono::steady_clock::now();
+	const int64_t delay = milliseconds - serverMilliseconds();
+	currentBeatMiliseconds = milliseconds;
 
-		// send all data
-		sendData();
+	// continue work finished by other threads
+	processTasks();
 
-		std::this_thread::sleep_until(next_time_point);
-	}
+	// place players whose login finished loading
+	g_loginqueue.processLogins();
+
+	// read data from connections
+	receiveData();
+
+	// move game
+	advanceGame(delay);
+
+	// send all data
+	sendData();
+
+	g_telemetry.addBeat(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
+	beat_number++;
 }
 
 void Game::shutdown()
@@ -95,6 +112,9 @@ void Game::announceMissileEffect(const Position& from_pos, const Position& to_po
 
 	std::unordered_set<Creature*> spectator_list;
 	getSpectators(spectator_list, x, y, radx, rady, true);
+
+	NetworkMessage msg;
+	Protocol::addMissile(msg, from_pos, to_pos, type);
 	
 	for (Creature* creature : spectator_list) {
 		if (Player* player = creature->getPlayer()) {
@@ -102,7 +122,7 @@ void Game::announceMissileEffect(const Position& from_pos, const Position& to_po
 				continue;
 			}
 
-			Protocol::sendMissile(player->connection_ptr, from_pos, to_pos, type);
+			Protocol::sendShared(player->connection_ptr, msg, MESSAGE_CLASS_COSMETIC);
 		}
 	}
 }
@@ -118,13 +138,16 @@ void Game::announceGraphicalEffect(int32_t x, int32_t y, int32_t z, uint8_t type
 	std::unordered_set<Creature*> spectator_list;
 	getSpectators(spectator_list, x, y, 16, 14, true);
 
+	NetworkMessage msg;
+	Protocol::addGraphicalEffect(msg, x, y, z, type);
+
 	for (Creature* creature : spectator_list) {
 		if (Player* player = creature->getPlayer()) {
 			if (!player->canSeePosition(x, y, z)) {
 				continue;
 			}
 
-			Protocol::sendGraphicalEffect(player->connection_ptr, x, y, z, type);
+			Protocol::sendShared(player->connection_ptr, msg, MESSAGE_CLASS_COSMETIC);
 		}
 	}
 }
@@ -134,13 +157,16 @@ void Game::announceAnimatedText(const Position& pos, uint8_t color, const std::s
 	std::unordered_set<Creature*> spectator_list;
 	getSpectators(spectator_list, pos.x, pos.y, 16, 14, true);
 
+	NetworkMessage msg;
+	Protocol::addAnimatedText(msg, pos, color, text);
+
 	for (Creature* creature : spectator_list) {
 		if (Player* player = creature->getPlayer()) {
 			if (!player->canSeePosition(pos) || player->getPosition().z != pos.z) {
 				continue;
 			}
 
-			Protocol::sendAnimatedText(player->connection_ptr, pos, color, text);
+			Protocol::sendShared(player->connection_ptr, msg, MESSAGE_CLASS_COSMETIC);
 		}
 	}
 }
@@ -163,13 +189,44 @@ void Game::announceChangedField(Object* object, AnnounceType_t type)
 
 	getSpectators(spectator_list, pos.x, pos.y, 16, 14, true);
 
+	// covers changeItem and amount or liquid changes of items lying on the tile
+	if (type == ANNOUNCE_CHANGE) {
+		object->getParent()->getTile()->invalidateEncoding();
+	}
+
+	// items and deletions look the same to every spectator, creatures depend on what each client knows
+	NetworkMessage msg;
+	bool shared = false;
+	if (type == ANNOUNCE_DELETE) {
+		const int32_t index = object->getObjectIndex();
+		if (index < 10) {
+			Protocol::addDeleteField(msg, pos, index);
+		}
+		shared = true;
+	} else if (const Item* item = object->getItem()) {
+		if (type == ANNOUNCE_CREATE) {
+			Protocol::addAddField(msg, item);
+			shared = true;
+		} else if (type == ANNOUNCE_CHANGE) {
+			const int32_t index = object->getObjectIndex();
+			if (index < 10) {
+				Protocol::addChangeField(msg, item, index);
+			}
+			shared = true;
+		}
+	}
+
 	for (Creature* creature : spectator_list) {
 		if (Player* player = creature->getPlayer()) {
 			if (!player->canSeePosition(pos)) {
 				continue;
 			}
 
-			if (type == ANNOUNCE_CREATE) {
+			if (shared) {
+				if (msg.getLength() != 0) {
+					Protocol::sendShared(player->connection_ptr, msg);
+				}
+			} else if (type == ANNOUNCE_CREATE) {
 				if (player == object) {
 					Protocol::sendInitGame(player->connection_ptr);
 					Protocol::sendAmbiente(player->connection_ptr);
@@ -188,8 +245,6 @@ void Game::announceChangedField(Object* object, AnnounceType_t type)
 				}
 			} else if (type == ANNOUNCE_CHANGE) {
 				Protocol::sendChangeField(player->connection_ptr, object);
-			} else if (type == ANNOUNCE_DELETE) {
-				Protocol::sendDeleteField(player->connection_ptr, object->getPosition(), object->getObjectIndex());
 			}
 		}
 	}
@@ -269,6 +324,16 @@ void Game::announceMovingCreature(Creature* creature, const Position& from_pos,
 }
 
 void Game::announceChangedCreature(Creature* creature, CreatureChangeType_t type)
+{
+	// only the last state of the beat is sent, see sendChangedCreatures
+	if (creature->changed_types == 0) {
+		changed_creatures.push_back(creature);
+	}
+
+	creature->changed_types |= 1 << type;
+}
+
+void Game::sendChangedCreature(Creature* creature, CreatureChangeType_t type)
 {
 	std::unordered_set<Creature*> spectator_list;
 	const Position& pos = creature->getPosition();
@@ -306,6 +371,27 @@ void Game::announceChangedCreature(Creature* creature, CreatureChangeType_t type
 	}
 }
 
+void Game::sendChangedCreatures()
+{
+	for (Creature* creature : changed_creatures) {
+		const uint8_t changed_types = creature->changed_types;
+		creature->changed_types = 0;
+
+		// spectators were told about the removal already
+		if (creature->removed) {
+			continue;
+		}
+
+		for (uint8_t type = CREATURE_HEALTH; type <= CREATURE_PARTY; type++) {
+			if (changed_types & (1 << type)) {
+				sendChangedCreature(creature, static_cast<CreatureChangeType_t>(type));
+			}
+		}
+	}
+
+	changed_creatures.clear();
+}
+
 void Game::getSpectators(std::unordered_set<Creature*>& spectator_list, int32_t centerx, int32_t centery, int32_t rangex, int32_t rangey, bool only_players)
 {
 	for (int32_t x = centerx - rangex; x <= centerx + rangex; x++) {
@@ -465,6 +551,20 @@ void Game::removeConnection(Connection_ptr connection)
 	connection_mutex.unlock();
 }
 
+void Game::addReadyConnection(Connection* connection)
+{
+	Connection* head = ready_connections.load(std::memory_order_relaxed);
+	do {
+		connection->next_ready = head;
+	} while (!ready_connections.compare_exchange_weak(head, connection, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void Game::addTask(Task task)
+{
+	std::lock_guard<std::mutex> lockClass(task_mutex);
+	tasks.emplace_back(std::move(task));
+}
+
 void Game::decayItem(Item* item)
 {
 	if (item->decaying) {
@@ -476,6 +576,17 @@ void Game::decayItem(Item* item)
 	decaying_list[random(0, DECAY_SIZE - 1)].push_back(item);
 }
 
+void Game::startDecay(Item* item)
+{
+	if (item->getFlag(EXPIRE) && !item->decaying) {
+		decayItem(item);
+	}
+
+	for (Item* container_item : item->getItems()) {
+		startDecay(container_item);
+	}
+}
+
 void Game::stopDecay(Item* item) const
 {
 	if (!item->decaying) {
@@ -669,6 +780,17 @@ void Game::addCreatureSkillCheck(Creature* creature)
 	creature_skills[random(0, CREATURE_SKILL_SIZE - 1)].push_back(creature);
 }
 
+void Game::startPlayerTimers(Player* player)
+{
+	for (uint8_t slot = INVENTORY_HEAD; slot <= INVENTORY_EXTRA; slot++) {
+		if (Item* item = player->getInventoryItem(static_cast<InventorySlot_t>(slot))) {
+			startDecay(item);
+		}
+	}
+
+	addCreatureSkillCheck(player);
+}
+
 void Game::addPlayerList(Player* player)
 {
 	players.push_back(player);
@@ -3096,6 +3218,8 @@ void Game::loginPlayers(int32_t count)
 			return;
 		}
 
+		startPlayerTimers(player);
+
 		const Position& pos = player->getPosition();
 		if (setCreatureOnMap(player, pos.x, pos.y, pos.z) != ALLGOOD) {
 			//return;
@@ -4249,6 +4373,15 @@ void Game::advanceGame(int32_t delay)
 		}
 
 		processConnections();
+
+		StatusSnapshot snapshot;
+		snapshot.players_online = static_cast<uint32_t>(players.size());
+		snapshot.round_number = round_number;
+		g_status.publish(snapshot);
+
+		if (g_config.StatsInterval != 0 && round_number % g_config.StatsInterval == 0) {
+			g_telemetry.dumpAsync(g_config.StatsFile);
+		}
 	}
 
 	if (creature_time_counter > 1749) {
@@ -4262,6 +4395,8 @@ void Game::advanceGame(int32_t delay)
 	} else {
 		moveCreatures();
 	}
+
+	sendChangedCreatures();
 }
 
 void Game::processConnections()
@@ -4305,6 +4440,7 @@ void Game::processConnections()
 	connection_mutex.lock();
 	for (auto it = connections.begin(); it != connections.end();) {
 		const Connection_ptr connection = *it;
+		connection->checkBandwidth();
 		if (connection->getState() == CONNECTION_STATE_CLOSED) {
 			it = connections.erase(it);
 		} else {
@@ -4407,15 +4543,44 @@ void Game::processCreatures()
 	}
 }
 
+void Game::processTasks()
+{
+	std::vector<Task> pending_tasks;
+
+	{
+		std::lock_guard<std::mutex> lockClass(task_mutex);
+		pending_tasks.swap(tasks);
+	}
+
+	for (const Task& task : pending_tasks) {
+		task();
+	}
+}
+
 void Game::receiveData()
 {
-	connection_mutex.lock();
-	for (Connection_ptr connection : connections) {
-		if (connection->pending_data > 0) {
-			connection->parseData();
-		}
+	Connection* connection = ready_connections.exchange(nullptr, std::memory_order_acquire);
+
+	// connections are pushed in front, restore arrival order
+	Connection* ordered = nullptr;
+	while (connection) {
+		Connection* next = connection->next_ready;
+		connection->next_ready = ordered;
+		ordered = connection;
+		connection = next;
+	}
+
+	while (ordered) {
+		const Connection_ptr holder = std::move(ordered->ready_self);
+		Connection* next = ordered->next_ready;
+		ordered->next_ready = nullptr;
+
+		ordered->ready = false;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		ordered->parseData();
+
+		ordered = next;
 	}
-	connection_mutex.unlock();
 }
 
 void Game::sendData()
@@ -3,6 +3,7 @@
 #include "enums.h"
 #include "connection.h"
 #include "object.h"
+#include "taskpool.h"
 
 #include <queue>
 #include <set>
@@ -115,6 +116,11 @@ public:
 	~Game();
 
 	void launchGame();
+	// runs one beat with the clock set to milliseconds, used by launchGame and the replay harness
+	void runBeat(uint64_t milliseconds);
+	void resetClock(uint64_t milliseconds) {
+		currentBeatMiliseconds = milliseconds;
+	}
 	void shutdown();
 
 	void setGameState(GameState_t new_state);
@@ -129,6 +135,9 @@ public:
 	uint32_t getRoundNr() const {
 		return round_number;
 	}
+	uint32_t getBeatNr() const {
+		return beat_number;
+	}
 
 	const std::vector<Player*>& getPlayers() const {
 		return players;
@@ -154,8 +163,13 @@ public:
 
 	void addConnection(Connection_ptr connection);
 	void removeConnection(Connection_ptr connection);
+	void addReadyConnection(Connection* connection);
+
+	// runs the task on the game thread at the start of the next beat, safe to call from any thread
+	void addTask(Task task);
 
 	void decayItem(Item* item);
+	void startDecay(Item* item);
 	void stopDecay(Item* item) const;
 
 	void moveAllObjects(Tile* tile, Tile* to_tile, Object* ignore_object, bool move_unmovable);
@@ -164,6 +178,8 @@ public:
 
 	void queueCreature(Creature* creature);
 	void addCreatureSkillCheck(Creature* creature);
+	// Player::loadData leaves the inventory decay and the skill checks to the game thread
+	void startPlayerTimers(Player* player);
 	void addPlayerList(Player* player);
 	void addCreatureList(Creature* creature);
 	void storePlayer(Player* player, uint32_t user_id);
@@ -289,6 +305,10 @@ private:
 	void processSkills();
 	void processCreatures();
 
+	void sendChangedCreature(Creature* creature, CreatureChangeType_t type);
+	void sendChangedCreatures();
+
+	void processTasks();
 	void receiveData();
 	void sendData();
 
@@ -304,6 +324,9 @@ private:
 
 	std::vector<Creature*> removed_creatures{};
 
+	// creatures with state changes to announce at the end of the beat, see Creature::changed_types
+	std::vector<Creature*> changed_creatures{};
+
 	std::vector<Creature*> creatures{};
 	std::vector<Player*> players{};
 
@@ -318,6 +341,12 @@ private:
 
 	std::recursive_mutex connection_mutex;
 
+	// connections with parsed packets waiting, pushed by I/O threads without locking
+	std::atomic<Connection*> ready_connections{ nullptr };
+
+	std::vector<Task> tasks{};
+	std::mutex task_mutex;
+
 	Position newbie_start_pos;
 
 	GameState_t game_state = GAME_STARTING;
@@ -331,6 +360,7 @@ private:
 	int32_t skill_time_counter = 0;
 	int32_t creature_time_counter = 0;
 	int32_t round_number = 0;
+	std::atomic<uint32_t> beat_number{ 0 };
 
 	uint64_t currentBeatMiliseconds = 0;
 
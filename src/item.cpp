@@ -398,7 +398,7 @@ ItemType* Items::getSpecialItem(SpecialMeaning_t meaning) const
 	return it->second;
 }
 
-bool Item::createItem(uint16_t type_id)
+bool Item::createItem(uint16_t type_id, bool decay)
 {
 	item_type = g_items.getItemType(type_id);
 	if (item_type == nullptr || type_id < 100) {
@@ -408,7 +408,9 @@ bool Item::createItem(uint16_t type_id)
 
 	if (getFlag(EXPIRE)) {
 		setAttribute(ITEM_REMAINING_EXPIRE_TIME, getAttribute(TOTALEXPIRETIME) * 1000);
-		g_game.decayItem(this);
+		if (decay) {
+			g_game.decayItem(this);
+		}
 	}
 
 	return true;
@@ -692,7 +694,7 @@ bool Item::hasParentContainer() const
 	return parent->getItem() != nullptr;
 }
 
-bool Item::loadData(ScriptReader& script)
+bool Item::loadData(ScriptReader& script, bool decay)
 {
 	while (script.canRead()) {
 		script.nextToken();
@@ -733,7 +735,7 @@ bool Item::loadData(ScriptReader& script)
 			} else if (identifier == "editor") {
 				editor = script.readString();
 			} else if (identifier == "content") {
-				if (!loadContent(script)) {
+				if (!loadContent(script, decay)) {
 					script.error("failed to load content");
 					return false;
 				}
@@ -751,7 +753,7 @@ bool Item::loadData(ScriptReader& script)
 	return true;
 }
 
-bool Item::loadContent(ScriptReader& script)
+bool Item::loadContent(ScriptReader& script, bool decay)
 {
 	script.readSymbol('{');
 	script.nextToken();
@@ -759,7 +761,7 @@ bool Item::loadContent(ScriptReader& script)
 		if (script.getToken() == TOKEN_NUMBER) {
 			const uint16_t type_id = script.getNumber();
 
-			Item* new_item = g_itempool.createItem(type_id);
+			Item* new_item = g_itempool.createItem(type_id, decay);
 			if (new_item == nullptr) {
 				script.error("unknown type id");
 				return false;
@@ -767,7 +769,7 @@ bool Item::loadContent(ScriptReader& script)
 
 			addObject(new_item, INDEX_ANYWHERE);
 
-			if (!new_item->loadData(script)) {
+			if (!new_item->loadData(script, decay)) {
 				return false;
 			}
 		} else if (script.getToken() == TOKEN_SPECIAL) {
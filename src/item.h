@@ -92,7 +92,7 @@ class Item : public Cylinder
 {
 protected:
 	explicit Item() = default;
-	bool createItem(uint16_t type_id);
+	bool createItem(uint16_t type_id, bool decay);
 public:
 	//static Item* createItem(uint16_t type_id);
 
@@ -160,8 +160,9 @@ public:
 
 	bool hasParentContainer() const;
 
-	bool loadData(ScriptReader& script);
-	bool loadContent(ScriptReader& script);
+	// items of a user file are loaded with decay false, the game thread starts their decay later
+	bool loadData(ScriptReader& script, bool decay = true);
+	bool loadContent(ScriptReader& script, bool decay = true);
 
 	ReturnValue_t queryAdd(int32_t index, const Object* object, uint32_t amount, uint32_t flags, Creature* actor) const final;
 	ReturnValue_t queryMaxCount(int32_t index, const Object* object, uint32_t amount, uint32_t& max_amount, uint32_t flags) const final;
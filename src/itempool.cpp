@@ -25,8 +25,11 @@ void ItemPool::allocate(uint32_t count)
 	}
 }
 
-Item* ItemPool::createItem(uint16_t type_id)
+Item* ItemPool::createItem(uint16_t type_id, bool decay)
 {
+	// login workers create the inventory of players being loaded
+	std::lock_guard<std::mutex> lockClass(mutex);
+
 	if (free_items.empty()) {
 		reallocate();
 	}
@@ -36,7 +39,7 @@ Item* ItemPool::createItem(uint16_t type_id)
 		fmt::printf("ERROR - ItemPool::createItem: item is not free (%s)\n", item->getName(-1));
 	}
 
-	if (!item->createItem(type_id)) {
+	if (!item->createItem(type_id, decay)) {
 		return nullptr;
 	}
 
@@ -47,6 +50,8 @@ Item* ItemPool::createItem(uint16_t type_id)
 
 void ItemPool::freeItem(Item* item)
 {
+	std::lock_guard<std::mutex> lockClass(mutex);
+
 	if (item->removed) {
 		fmt::printf("ERROR - ItemPool::deleteItem: item is already removed (%s).\n", item->getName(-1));
 		return;
@@ -10,11 +10,12 @@ public:
 
 	void allocate(uint32_t count);
 
-	Item* createItem(uint16_t type_id);
+	Item* createItem(uint16_t type_id, bool decay = true);
 	void freeItem(Item* item);
 private:
 	void reallocate();
 
+	std::mutex mutex;
 	std::vector<Item*> items;
 	std::forward_list<Item*> free_items;
 };
@@ -0,0 +1,131 @@
+#include "pch.h"
+
+#include "knowncreatures.h"
+#include "creature.h"
+
+KnownCreatures::KnownCreatures()
+{
+	index.fill(INVALID_SLOT);
+}
+
+bool KnownCreatures::checkCreature(const Creature* creature, const Creature* viewer, uint32_t& removed_id)
+{
+	const uint32_t creature_id = creature->getId();
+
+	uint16_t slot = findSlot(creature_id);
+	if (slot != INVALID_SLOT) {
+		unlink(slot);
+		link(slot);
+		removed_id = 0;
+		return true;
+	}
+
+	if (count == KNOWN_CREATURES_CAPACITY) {
+		slot = evictSlot(viewer);
+		removed_id = slots[slot].creature_id;
+		removeIndex(removed_id);
+		unlink(slot);
+	} else {
+		slot = count++;
+		removed_id = 0;
+	}
+
+	slots[slot].creature_id = creature_id;
+	slots[slot].creature = creature;
+	link(slot);
+	addIndex(slot);
+	return false;
+}
+
+void KnownCreatures::clear()
+{
+	index.fill(INVALID_SLOT);
+	most_recent = INVALID_SLOT;
+	least_recent = INVALID_SLOT;
+	count = 0;
+}
+
+uint16_t KnownCreatures::findSlot(uint32_t creature_id) const
+{
+	for (uint16_t i = getBucket(creature_id);; i = (i + 1) & (INDEX_SIZE - 1)) {
+		const uint16_t slot = index[i];
+		if (slot == INVALID_SLOT || slots[slot].creature_id == creature_id) {
+			return slot;
+		}
+	}
+}
+
+uint16_t KnownCreatures::evictSlot(const Creature* viewer)
+{
+	// creatures are only freed on shutdown, a removed one is still safe to look at
+	for (uint16_t slot = least_recent; slot != INVALID_SLOT; slot = slots[slot].prev) {
+		const Creature* creature = slots[slot].creature;
+		if (creature->isRemoved() || !viewer || !viewer->canSeeCreature(creature)) {
+			return slot;
+		}
+	}
+
+	// everyone is in sight, forget whoever was seen the longest time ago
+	return least_recent;
+}
+
+void KnownCreatures::link(uint16_t slot)
+{
+	KnownCreature& known_creature = slots[slot];
+	known_creature.prev = INVALID_SLOT;
+	known_creature.next = most_recent;
+
+	if (most_recent != INVALID_SLOT) {
+		slots[most_recent].prev = slot;
+	} else {
+		least_recent = slot;
+	}
+
+	most_recent = slot;
+}
+
+void KnownCreatures::unlink(uint16_t slot)
+{
+	const KnownCreature& known_creature = slots[slot];
+
+	if (known_creature.prev != INVALID_SLOT) {
+		slots[known_creature.prev].next = known_creature.next;
+	} else {
+		most_recent = known_creature.next;
+	}
+
+	if (known_creature.next != INVALID_SLOT) {
+		slots[known_creature.next].prev = known_creature.prev;
+	} else {
+		least_recent = known_creature.prev;
+	}
+}
+
+void KnownCreatures::addIndex(uint16_t slot)
+{
+	uint16_t i = getBucket(slots[slot].creature_id);
+	while (index[i] != INVALID_SLOT) {
+		i = (i + 1) & (INDEX_SIZE - 1);
+	}
+
+	index[i] = slot;
+}
+
+void KnownCreatures::removeIndex(uint32_t creature_id)
+{
+	uint16_t hole = getBucket(creature_id);
+	while (slots[index[hole]].creature_id != creature_id) {
+		hole = (hole + 1) & (INDEX_SIZE - 1);
+	}
+
+	// shift following entries back so lookups never run into a gap before their entry
+	for (uint16_t i = (hole + 1) & (INDEX_SIZE - 1); index[i] != INVALID_SLOT; i = (i + 1) & (INDEX_SIZE - 1)) {
+		const uint16_t bucket = getBucket(slots[index[i]].creature_id);
+		if (((i - bucket) & (INDEX_SIZE - 1)) >= ((i - hole) & (INDEX_SIZE - 1))) {
+			index[hole] = index[i];
+			hole = i;
+		}
+	}
+
+	index[hole] = INVALID_SLOT;
+}
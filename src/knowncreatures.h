@@ -0,0 +1,48 @@
+#pragma once
+
+class Creature;
+
+static constexpr uint16_t KNOWN_CREATURES_CAPACITY = 150;
+
+// Mirrors the client's table of creatures it has been sent a full description of.
+// Entries are linked from most to least recently seen and found through an open addressing
+// index, nothing is allocated after construction.
+class KnownCreatures
+{
+public:
+	explicit KnownCreatures();
+
+	// marks the creature as seen, if it was unknown removed_id is the creature the client has to forget (or 0)
+	bool checkCreature(const Creature* creature, const Creature* viewer, uint32_t& removed_id);
+	void clear();
+private:
+	static constexpr uint16_t INDEX_SIZE = 256;
+	static constexpr uint16_t INVALID_SLOT = 0xFFFF;
+
+	struct KnownCreature
+	{
+		uint32_t creature_id = 0;
+		const Creature* creature = nullptr;
+		uint16_t prev = INVALID_SLOT;
+		uint16_t next = INVALID_SLOT;
+	};
+
+	static uint16_t getBucket(uint32_t creature_id) {
+		return (creature_id * 2654435761U) >> 24;
+	}
+
+	uint16_t findSlot(uint32_t creature_id) const;
+	uint16_t evictSlot(const Creature* viewer);
+
+	void link(uint16_t slot);
+	void unlink(uint16_t slot);
+	void addIndex(uint16_t slot);
+	void removeIndex(uint32_t creature_id);
+
+	std::array<KnownCreature, KNOWN_CREATURES_CAPACITY> slots;
+	std::array<uint16_t, INDEX_SIZE> index;
+
+	uint16_t most_recent = INVALID_SLOT;
+	uint16_t least_recent = INVALID_SLOT;
+	uint16_t count = 0;
+};
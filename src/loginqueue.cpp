@@ -0,0 +1,181 @@
+#include "pch.h"
+
+#include "loginqueue.h"
+#include "protocol.h"
+#include "game.h"
+#include "player.h"
+#include "item.h"
+#include "map.h"
+#include "config.h"
+#include "taskpool.h"
+#include "capture.h"
+
+static int64_t getMicroseconds()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LoginQueue::addLogin(Connection_ptr connection, uint8_t protocol_type, NetworkMessage&& msg)
+{
+	// the symmetric key is still encrypted, there is no way to tell the client why
+	if (getPendingLogins() >= g_config.LoginQueueSize) {
+		connection->close();
+		return;
+	}
+
+	decrypting++;
+
+	const int64_t start_time = getMicroseconds();
+	auto login_msg = std::make_shared<NetworkMessage>(std::move(msg));
+	g_taskpool.addTask([this, connection, protocol_type, login_msg, start_time]() {
+		login_msg->skipBytes(protocol_type == 0x01 ? 16 : 4);
+		const bool decrypted = login_msg->rsaDecrypt();
+
+		g_game.addTask([this, connection, protocol_type, login_msg, start_time, decrypted]() {
+			decrypting--;
+			addStageTime(LOGIN_STAGE_DECRYPT, start_time);
+
+			if (connection->getState() != CONNECTION_STATE_OPEN) {
+				return;
+			}
+
+			if (!decrypted) {
+				connection->close();
+				return;
+			}
+
+			if (protocol_type == 0x01) {
+				Protocol::parseCharacterList(connection, *login_msg);
+			} else {
+				Protocol::parseCharacterLogin(connection, *login_msg);
+			}
+		});
+	});
+}
+
+void LoginQueue::addPlayer(Connection_ptr connection, uint32_t user_id)
+{
+	g_capture.addLogin(*connection, user_id);
+
+	if (Player* player = g_game.getPlayerByUserId(user_id)) {
+		player->takeOver(connection);
+		return;
+	}
+
+	if (loading_users.find(user_id) != loading_users.end()) {
+		Protocol::sendLoginDisconnect(connection, 0x14, "Your character is already logging in.\nPlease try again later.");
+		return;
+	}
+
+	if (getPendingLogins() >= g_config.LoginQueueSize) {
+		Protocol::sendLoginDisconnect(connection, 0x14, "Too many players are logging in.\nPlease try again later.");
+		return;
+	}
+
+	LoginRequest request;
+	request.connection = connection;
+	request.user_id = user_id;
+	request.stage_time = getMicroseconds();
+
+	request.player = g_game.getStoredPlayer(user_id);
+	if (request.player) {
+		admissions.push_back(std::move(request));
+		return;
+	}
+
+	// parsing does not touch game state, skill timers and item decay are registered in onPlayerLoaded
+	loading_users.insert(user_id);
+	g_taskpool.addTask([this, request]() mutable {
+		request.player = new Player();
+		const bool loaded = request.player->loadData(request.user_id);
+
+		g_game.addTask([this, request, loaded]() mutable {
+			onPlayerLoaded(std::move(request), loaded);
+		});
+	});
+}
+
+void LoginQueue::onPlayerLoaded(LoginRequest&& request, bool loaded)
+{
+	loading_users.erase(request.user_id);
+	addStageTime(LOGIN_STAGE_LOAD, request.stage_time);
+
+	if (!loaded) {
+		delete request.player;
+		Protocol::sendLoginDisconnect(request.connection, 0x14, "Invalid player data.");
+		return;
+	}
+
+	g_game.startPlayerTimers(request.player);
+	g_game.storePlayer(request.player, request.user_id);
+
+	request.stage_time = getMicroseconds();
+	admissions.push_back(std::move(request));
+}
+
+void LoginQueue::processLogins()
+{
+	uint32_t admitted = 0;
+	while (!admissions.empty() && admitted < g_config.LoginsPerBeat) {
+		LoginRequest request = std::move(admissions.front());
+		admissions.pop_front();
+
+		addStageTime(LOGIN_STAGE_ADMIT, request.stage_time);
+
+		if (request.connection->getState() != CONNECTION_STATE_OPEN) {
+			continue;
+		}
+
+		admitPlayer(request);
+		admitted++;
+	}
+}
+
+void LoginQueue::admitPlayer(LoginRequest& request)
+{
+	Player* player = g_game.getPlayerByUserId(request.user_id);
+	if (player) {
+		player->takeOver(request.connection);
+		return;
+	}
+
+	player = request.player;
+
+	Position pos = player->getPosition();
+
+	player->setConnection(request.connection);
+	request.connection->setPlayer(player);
+
+	if (!g_map.searchFreeField(player, pos, 1)) {
+		pos = g_game.getNewbieStart();
+	}
+
+	if (g_game.setCreatureOnMap(player, pos.x, pos.y, pos.z) != ALLGOOD) {
+		Protocol::sendLoginDisconnect(request.connection, 0x14, "Invalid position for player.");
+	}
+}
+
+void LoginQueue::addStageTime(LoginStage_t stage, int64_t start_time)
+{
+	const int64_t elapsed = getMicroseconds() - start_time;
+
+	LoginStageStatistics& stage_statistics = statistics[stage];
+	stage_statistics.count++;
+	stage_statistics.total_time += elapsed;
+	stage_statistics.max_time = std::max(stage_statistics.max_time, elapsed);
+}
+
+void LoginQueue::printStatistics() const
+{
+	static const char* stage_names[LOGIN_STAGE_COUNT] = { "decrypt", "load", "admit" };
+
+	for (uint8_t i = LOGIN_STAGE_DECRYPT; i != LOGIN_STAGE_COUNT; i++) {
+		const LoginStageStatistics& stage_statistics = statistics[i];
+		if (stage_statistics.count == 0) {
+			continue;
+		}
+
+		fmt::printf(">> Login %s: %d logins, %.2f ms average, %.2f ms max.\n", stage_names[i], stage_statistics.count,
+			stage_statistics.total_time / 1000.0 / stage_statistics.count, stage_statistics.max_time / 1000.0);
+	}
+}
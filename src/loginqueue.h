@@ -0,0 +1,67 @@
+#pragma once
+
+#include "connection.h"
+
+class Player;
+
+enum LoginStage_t : uint8_t
+{
+	LOGIN_STAGE_DECRYPT,
+	LOGIN_STAGE_LOAD,
+	LOGIN_STAGE_ADMIT,
+
+	LOGIN_STAGE_COUNT,
+};
+
+struct LoginStageStatistics
+{
+	uint64_t count = 0;
+	int64_t total_time = 0;
+	int64_t max_time = 0;
+};
+
+struct LoginRequest
+{
+	Connection_ptr connection;
+	uint32_t user_id = 0;
+	Player* player = nullptr;
+	int64_t stage_time = 0;
+};
+
+// Staged login: the RSA block is decrypted and the player file parsed on g_taskpool,
+// loaded players are placed on the map by the game thread at most LoginsPerBeat per beat.
+// Everything here is owned by the game thread, workers only report back through Game::addTask.
+class LoginQueue
+{
+public:
+	explicit LoginQueue() = default;
+
+	LoginQueue(const LoginQueue&) = delete;
+	LoginQueue& operator=(const LoginQueue&) = delete;
+
+	void addLogin(Connection_ptr connection, uint8_t protocol_type, NetworkMessage&& msg);
+	// players already online take over the connection right away
+	void addPlayer(Connection_ptr connection, uint32_t user_id);
+
+	void processLogins();
+
+	uint32_t getPendingLogins() const {
+		return decrypting + static_cast<uint32_t>(loading_users.size() + admissions.size());
+	}
+	const LoginStageStatistics& getStatistics(LoginStage_t stage) const {
+		return statistics[stage];
+	}
+	void printStatistics() const;
+private:
+	void onPlayerLoaded(LoginRequest&& request, bool loaded);
+	void admitPlayer(LoginRequest& request);
+	void addStageTime(LoginStage_t stage, int64_t start_time);
+
+	std::deque<LoginRequest> admissions;
+	std::unordered_set<uint32_t> loading_users;
+	uint32_t decrypting = 0;
+
+	std::array<LoginStageStatistics, LOGIN_STAGE_COUNT> statistics{};
+};
+
+extern LoginQueue g_loginqueue;
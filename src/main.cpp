@@ -10,22 +10,35 @@
 #include "magic.h"
 #include "vocation.h"
 #include "itempool.h"
-
-boost::asio::io_service io_service;
+#include "messagepool.h"
+#include "xtea.h"
+#include "taskpool.h"
+#include "loginqueue.h"
+#include "capture.h"
+#include "replay.h"
+#include "telemetry.h"
+#include "status.h"
 
 Config g_config;
 Vocations g_vocations;
 Items g_items;
 TRSA RSA;
 Channels g_channels;
+MessagePool g_messagepool;
+Server g_server;
 Game g_game;
+TaskPool g_taskpool;
+LoginQueue g_loginqueue;
+Capture g_capture;
+Telemetry g_telemetry;
+Status g_status;
 ItemPool g_itempool;
 Map g_map;
 Magic g_magic;
 
 bool initAll();
 
-int main(int, char**)
+int main(int argc, char** argv)
 {
 #ifdef _WIN32
 	SetConsoleTitle("Tibia Game Server");
@@ -35,7 +48,6 @@ int main(int, char**)
 	fmt::printf(":: A Tibia server reverse engineering progress\n");
 	fmt::printf(":: By Ezzz (Alejandro Mujica)\n\n");
 
-	std::srand(time(nullptr));
 	g_game.setGameState(GAME_STARTING);
 
 	if (!g_config.loadConfig()) {
@@ -43,16 +55,43 @@ int main(int, char**)
 		return false;
 	}
 
-	const char* p("14299623962416399520070177382898895550795403345466153217470516082934737582776038882967213386204600674145392845853859217990626450972452084065728686565928113");
-	const char* q("7630979195970404721891201847792002125535401292779123937207447574596692788513647179235335529307251350570728407373705564708871762033017096809910315212884101");
-	RSA.setKey(p, q);
+	// --replay <file> runs a capture through the game without opening the server
+	std::unique_ptr<Replay> replay;
+	uint32_t seed = static_cast<uint32_t>(time(nullptr));
+	if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+		replay.reset(new Replay());
+		if (!replay->load(argv[2])) {
+			return 0;
+		}
+		seed = replay->getSeed();
+	} else if (!g_config.CaptureFile.empty()) {
+		if (!g_capture.open(g_config.CaptureFile, seed)) {
+			std::cin.get();
+			return 0;
+		}
+		fmt::printf(">> Capturing inbound packets to %s.\n", g_config.CaptureFile);
+	}
+	std::srand(seed);
+
+	RSA.setKey(RSA_PRIME_P, RSA_PRIME_Q);
+
+	fmt::printf(">> Using %s XTEA kernel.\n", XTEA::getKernelName());
+
+	g_taskpool.start(g_config.WorkerThreads);
 
-	Server server(io_service);
-	server.open();
+	if (replay) {
+		if (initAll()) {
+			replay->run();
+			g_telemetry.dump(g_config.StatsFile);
+		}
+		g_taskpool.stop();
+		return 0;
+	}
 
-	std::thread io_thread([]() {
-		io_service.run();
-	});
+	if (!g_server.open()) {
+		std::cin.get();
+		return 0;
+	}
 
 	if (!initAll()) {
 		fmt::printf(">> FATAL: g_game server is not online!\n");
@@ -62,15 +101,22 @@ int main(int, char**)
 
 	SetConsoleCtrlHandler([](DWORD) -> BOOL {
 		fmt::printf(">> Shutting down...\n");
+		fmt::printf(">> Message pool hit rate: %.2f%% (%d hits, %d misses).\n", g_messagepool.getHitRate() * 100, g_messagepool.getHits(), g_messagepool.getMisses());
+		g_server.printStatistics();
+		fmt::printf(">> Answered %d status queries.\n", g_status.getQueries());
+		g_loginqueue.printStatistics();
+		g_capture.close();
+		g_telemetry.dump(g_config.StatsFile);
 
 		g_game.setGameState(GAME_OFFLINE);
-		io_service.stop();
+		g_server.close();
+		g_taskpool.stop();
 		ExitThread(0);
 	}, 1);
 
 	g_game.launchGame();
 
-	io_thread.join();
+	g_server.join();
 	return 0;
 }
 
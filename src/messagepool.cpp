@@ -0,0 +1,80 @@
+#include "pch.h"
+
+#include "messagepool.h"
+
+// buffers kept around per size class once released, anything above is returned to the system
+static constexpr std::array<uint32_t, MESSAGE_SIZE_COUNT> MESSAGE_POOL_LIMIT = { 8192, 2048, 256 };
+static constexpr std::array<uint16_t, MESSAGE_SIZE_COUNT> MESSAGE_CAPACITY = { 256, 2048, NETWORKMESSAGE_MAXSIZE };
+
+MessagePool::~MessagePool()
+{
+	for (std::vector<uint8_t*>& buffers : free_buffers) {
+		for (uint8_t* buffer : buffers) {
+			delete[] buffer;
+		}
+		buffers.clear();
+	}
+}
+
+uint16_t MessagePool::getCapacity(MessageSize_t size_class)
+{
+	return MESSAGE_CAPACITY[size_class];
+}
+
+MessageSize_t MessagePool::getSizeClass(uint32_t size)
+{
+	for (uint8_t i = MESSAGE_SIZE_SMALL; i != MESSAGE_SIZE_COUNT; i++) {
+		if (size <= MESSAGE_CAPACITY[i]) {
+			return static_cast<MessageSize_t>(i);
+		}
+	}
+
+	return MESSAGE_SIZE_LARGE;
+}
+
+uint8_t* MessagePool::acquireBuffer(MessageSize_t size_class)
+{
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+
+		std::vector<uint8_t*>& buffers = free_buffers[size_class];
+		if (!buffers.empty()) {
+			uint8_t* buffer = buffers.back();
+			buffers.pop_back();
+			hits++;
+			return buffer;
+		}
+	}
+
+	misses++;
+	return new uint8_t[MESSAGE_CAPACITY[size_class]];
+}
+
+void MessagePool::releaseBuffer(uint8_t* buffer, MessageSize_t size_class)
+{
+	if (buffer == nullptr) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+
+		std::vector<uint8_t*>& buffers = free_buffers[size_class];
+		if (buffers.size() < MESSAGE_POOL_LIMIT[size_class]) {
+			buffers.push_back(buffer);
+			return;
+		}
+	}
+
+	delete[] buffer;
+}
+
+double MessagePool::getHitRate() const
+{
+	const uint64_t total = hits + misses;
+	if (total == 0) {
+		return 0.0;
+	}
+
+	return static_cast<double>(hits) / total;
+}
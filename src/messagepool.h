@@ -0,0 +1,44 @@
+#pragma once
+
+static constexpr uint16_t NETWORKMESSAGE_MAXSIZE = 16384;
+
+enum MessageSize_t : uint8_t
+{
+	MESSAGE_SIZE_SMALL,
+	MESSAGE_SIZE_MEDIUM,
+	MESSAGE_SIZE_LARGE,
+
+	MESSAGE_SIZE_COUNT,
+};
+
+class MessagePool
+{
+public:
+	explicit MessagePool() = default;
+	~MessagePool();
+
+	MessagePool(const MessagePool&) = delete;
+	MessagePool& operator=(const MessagePool&) = delete;
+
+	static uint16_t getCapacity(MessageSize_t size_class);
+	static MessageSize_t getSizeClass(uint32_t size);
+
+	uint8_t* acquireBuffer(MessageSize_t size_class);
+	void releaseBuffer(uint8_t* buffer, MessageSize_t size_class);
+
+	uint64_t getHits() const {
+		return hits;
+	}
+	uint64_t getMisses() const {
+		return misses;
+	}
+	double getHitRate() const;
+private:
+	std::mutex mutex;
+	std::array<std::vector<uint8_t*>, MESSAGE_SIZE_COUNT> free_buffers{};
+
+	std::atomic<uint64_t> hits{ 0 };
+	std::atomic<uint64_t> misses{ 0 };
+};
+
+extern MessagePool g_messagepool;
@@ -2,6 +2,44 @@
 
 #include "networkmessage.h"
 #include "rsa.h"
+#include "xtea.h"
+
+NetworkMessage::NetworkMessage(MessageSize_t size_class) :
+	size_class(size_class),
+	buffer(g_messagepool.acquireBuffer(size_class))
+{
+	//
+}
+
+NetworkMessage::~NetworkMessage()
+{
+	g_messagepool.releaseBuffer(buffer, size_class);
+}
+
+NetworkMessage::NetworkMessage(NetworkMessage&& other) noexcept :
+	header_position(other.header_position),
+	position(other.position),
+	length(other.length),
+	size_class(other.size_class),
+	buffer(other.buffer)
+{
+	other.buffer = nullptr;
+}
+
+NetworkMessage& NetworkMessage::operator=(NetworkMessage&& other) noexcept
+{
+	if (this != &other) {
+		g_messagepool.releaseBuffer(buffer, size_class);
+
+		header_position = other.header_position;
+		position = other.position;
+		length = other.length;
+		size_class = other.size_class;
+		buffer = other.buffer;
+		other.buffer = nullptr;
+	}
+	return *this;
+}
 
 uint16_t NetworkMessage::getLengthHeader() const
 {
@@ -63,6 +101,21 @@ std::string NetworkMessage::readString(uint16_t stringLen/* = 0*/)
 	return std::string(v, stringLen);
 }
 
+std::string_view NetworkMessage::readStringView(uint16_t stringLen/* = 0*/)
+{
+	if (stringLen == 0) {
+		stringLen = readWord();
+	}
+
+	if (!canRead(stringLen)) {
+		return std::string_view();
+	}
+
+	const char* v = reinterpret_cast<const char*>(buffer) + position; //does not break strict aliasing
+	position += stringLen;
+	return std::string_view(v, stringLen);
+}
+
  void NetworkMessage::writeByte(uint8_t value)
 {
 	if (!canWrite(1)) {
@@ -112,6 +165,34 @@ void NetworkMessage::writeString(const std::string& value)
 	length += stringLen;
 }
 
+void NetworkMessage::writeBytes(const uint8_t* bytes, uint16_t size)
+{
+	if (size == 0 || !canWrite(size)) {
+		return;
+	}
+
+	memcpy(buffer + position, bytes, size);
+	position += size;
+	length += size;
+}
+
+bool NetworkMessage::reserve(uint32_t size)
+{
+	return canWrite(size);
+}
+
+bool NetworkMessage::appendMessage(const NetworkMessage& msg)
+{
+	if (!canWrite(msg.length)) {
+		return false;
+	}
+
+	memcpy(buffer + position, msg.buffer + msg.header_position, msg.length);
+	position += msg.length;
+	length += msg.length;
+	return true;
+}
+
  void NetworkMessage::writeHeader()
 {
 	header_position -= 2;
@@ -121,38 +202,13 @@ void NetworkMessage::writeString(const std::string& value)
 
 void NetworkMessage::xteaEncrypt(uint32_t* key)
 {
-	const uint32_t delta = 0x61C88647;
-
 	// The message must be a multiple of 8
 	const uint32_t paddingBytes = length % 8;
 	if (paddingBytes != 0) {
 		writePaddingBytes(8 - paddingBytes);
 	}
 
-	uint8_t* bufferPtr = buffer + header_position;
-	const uint32_t messageLength = length;
-	uint32_t readPos = 0;
-	const uint32_t k[] = { key[0], key[1], key[2], key[3] };
-	while (readPos < messageLength) {
-		uint32_t v0;
-		memcpy(&v0, bufferPtr + readPos, 4);
-		uint32_t v1;
-		memcpy(&v1, bufferPtr + readPos + 4, 4);
-
-		uint32_t sum = 0;
-
-		for (int32_t i = 32; --i >= 0;)
- {
-			v0 += ((v1 << 4 ^ v1 >> 5) + v1) ^ (sum + k[sum & 3]);
-			sum -= delta;
-			v1 += ((v0 << 4 ^ v0 >> 5) + v0) ^ (sum + k[(sum >> 11) & 3]);
-		}
-
-		memcpy(bufferPtr + readPos, &v0, 4);
-		readPos += 4;
-		memcpy(bufferPtr + readPos, &v1, 4);
-		readPos += 4;
-	}
+	XTEA::encrypt(buffer + header_position, length, key);
 }
 
 bool NetworkMessage::xteaDecrypt(uint32_t* key)
@@ -161,31 +217,7 @@ bool NetworkMessage::xteaDecrypt(uint32_t* key)
 		return false;
 	}
 
-	const uint32_t delta = 0x61C88647;
-
-	uint8_t* bufferPtr = buffer + position;
-	const uint32_t messageLength = length - 6;
-	uint32_t readPos = 0;
-	const uint32_t k[] = { key[0], key[1], key[2], key[3] };
-	while (readPos < messageLength) {
-		uint32_t v0;
-		memcpy(&v0, bufferPtr + readPos, 4);
-		uint32_t v1;
-		memcpy(&v1, bufferPtr + readPos + 4, 4);
-
-		uint32_t sum = 0xC6EF3720;
-
-		for (int32_t i = 32; --i >= 0;) {
-			v1 -= ((v0 << 4 ^ v0 >> 5) + v0) ^ (sum + k[(sum >> 11) & 3]);
-			sum += delta;
-			v0 -= ((v1 << 4 ^ v1 >> 5) + v1) ^ (sum + k[sum & 3]);
-		}
-
-		memcpy(bufferPtr + readPos, &v0, 4);
-		readPos += 4;
-		memcpy(bufferPtr + readPos, &v1, 4);
-		readPos += 4;
-	}
+	XTEA::decrypt(buffer + position, length - 2, key);
 
 	const int innerLength = readWord();
 	if (innerLength > length - 4) {
@@ -206,14 +238,18 @@ bool NetworkMessage::rsaDecrypt()
 	return readByte() == 0;
 }
 
- bool NetworkMessage::canWrite(uint32_t size) const
+ bool NetworkMessage::canWrite(uint32_t size)
 {
-	return (size + position) < MAX_BODY_LENGTH;
+	if ((size + position) < static_cast<uint32_t>(getCapacity() - HEADER_LENGTH - XTEA_MULTIPLE)) {
+		return true;
+	}
+
+	return grow(size);
 }
 
  bool NetworkMessage::canRead(int32_t size) const
  {
-	if ((position + size) > (length + 8) || size >= (NETWORKMESSAGE_MAXSIZE - position)) {
+	if ((position + size) > (length + 8) || size >= (getCapacity() - position)) {
 		return false;
 	}
 	return true;
@@ -228,3 +264,20 @@ void NetworkMessage::writePaddingBytes(uint32_t n)
 	memset(buffer + position, 0x33, n);
 	length += n;
 }
+
+bool NetworkMessage::grow(uint32_t size)
+{
+	const uint32_t required = size + position + HEADER_LENGTH + XTEA_MULTIPLE + 1;
+	if (required > NETWORKMESSAGE_MAXSIZE) {
+		return false;
+	}
+
+	const MessageSize_t new_size_class = MessagePool::getSizeClass(required);
+	uint8_t* new_buffer = g_messagepool.acquireBuffer(new_size_class);
+	memcpy(new_buffer, buffer, position);
+	g_messagepool.releaseBuffer(buffer, size_class);
+
+	buffer = new_buffer;
+	size_class = new_size_class;
+	return true;
+}
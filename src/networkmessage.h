@@ -1,6 +1,44 @@
 #pragma once
 
-static constexpr uint16_t NETWORKMESSAGE_MAXSIZE = 16384;
+#include "messagepool.h"
+
+// Unchecked stores into room a NetworkMessage has already reserved, see NetworkMessage::writeReserved
+class MessageWriter
+{
+public:
+	void addByte(uint8_t value) {
+		*cursor++ = value;
+	}
+	void addWord(uint16_t value) {
+		cursor[0] = static_cast<uint8_t>(value);
+		cursor[1] = static_cast<uint8_t>(value >> 8);
+		cursor += 2;
+	}
+	void addQuad(uint32_t value) {
+		cursor[0] = static_cast<uint8_t>(value);
+		cursor[1] = static_cast<uint8_t>(value >> 8);
+		cursor[2] = static_cast<uint8_t>(value >> 16);
+		cursor[3] = static_cast<uint8_t>(value >> 24);
+		cursor += 4;
+	}
+	void addBytes(const uint8_t* bytes, size_t size) {
+		memcpy(cursor, bytes, size);
+		cursor += size;
+	}
+	void addString(std::string_view value) {
+		addWord(static_cast<uint16_t>(value.size()));
+		addBytes(reinterpret_cast<const uint8_t*>(value.data()), value.size());
+	}
+private:
+	explicit MessageWriter(uint8_t* cursor) :
+		cursor(cursor) {
+		//
+	}
+
+	uint8_t* cursor;
+
+	friend class NetworkMessage;
+};
 
 class NetworkMessage
 {
@@ -9,6 +47,15 @@ public:
 	enum { XTEA_MULTIPLE = 8 };
 	enum { MAX_BODY_LENGTH = NETWORKMESSAGE_MAXSIZE - HEADER_LENGTH - XTEA_MULTIPLE };
 
+	explicit NetworkMessage(MessageSize_t size_class = MESSAGE_SIZE_SMALL);
+	~NetworkMessage();
+
+	// buffers are rented from g_messagepool, so messages may only be handed over
+	NetworkMessage(const NetworkMessage&) = delete;
+	NetworkMessage& operator=(const NetworkMessage&) = delete;
+	NetworkMessage(NetworkMessage&& other) noexcept;
+	NetworkMessage& operator=(NetworkMessage&& other) noexcept;
+
 	void setLength(uint16_t new_length) {
 		length = new_length;
 	}
@@ -24,6 +71,15 @@ public:
 	uint8_t* getBuffer() {
 		return buffer;
 	}
+	const uint8_t* getBodyBuffer() const {
+		return buffer + header_position;
+	}
+	const uint8_t* getReadBuffer() const {
+		return buffer + position;
+	}
+	uint16_t getCapacity() const {
+		return MessagePool::getCapacity(size_class);
+	}
 
 	uint16_t getLengthHeader() const;
 	void skipBytes(int16_t amount);
@@ -32,24 +88,64 @@ public:
 	uint16_t readWord();
 	uint32_t readQuad();
 	std::string readString(uint16_t stringLen = 0);
+	// points into the message buffer, only valid until the message is changed or released
+	std::string_view readStringView(uint16_t stringLen = 0);
 
 	void writeByte(uint8_t value);
 	void writeWord(uint16_t value);
 	void writeQuad(uint32_t value);
 	void writePaddingBytes(uint32_t n);
 	void writeString(const std::string& value);
+	void writeBytes(const uint8_t* bytes, uint16_t size);
 	void writeHeader();
 
+	bool appendMessage(const NetworkMessage& msg);
+
+	// checks for room once, fill may then store up to size bytes through the unchecked writer
+	bool reserve(uint32_t size);
+	template<typename Fill>
+	bool writeReserved(uint32_t size, Fill&& fill) {
+		if (!reserve(size)) {
+			return false;
+		}
+
+		MessageWriter writer(buffer + position);
+		fill(writer);
+
+		const uint16_t written = static_cast<uint16_t>(writer.cursor - (buffer + position));
+		position += written;
+		length += written;
+		return true;
+	}
+
+	// fixed layout records, fill has to store exactly Size bytes
+	template<uint16_t Size, typename Fill>
+	bool writeRecord(Fill&& fill) {
+		if (!reserve(Size)) {
+			return false;
+		}
+
+		MessageWriter writer(buffer + position);
+		fill(writer);
+
+		position += Size;
+		length += Size;
+		return true;
+	}
+
 	void xteaEncrypt(uint32_t* key);
 	bool xteaDecrypt(uint32_t* key);
 
 	bool rsaDecrypt();
 private:
-	inline bool canWrite(uint32_t size) const;
+	inline bool canWrite(uint32_t size);
 	inline bool canRead(int32_t size) const;
 
+	bool grow(uint32_t size);
+
 	uint16_t header_position = 4;
 	uint16_t position = 4;
 	uint16_t length = 0;
-	uint8_t buffer[NETWORKMESSAGE_MAXSIZE]{};
-};
\ No newline at end of file
+	MessageSize_t size_class = MESSAGE_SIZE_SMALL;
+	uint8_t* buffer = nullptr;
+};
@@ -228,7 +228,7 @@ bool Player::loadData(uint32_t user_id, bool set_inventory)
 				}
 				
 				if (skill_nr == 4) {
-					skill_go_strength->setBaseSpeed(actual);
+					skill_go_strength->loadBaseSpeed(actual);
 				}
 
 				if (skill_nr == 5) {
@@ -278,31 +278,31 @@ bool Player::loadData(uint32_t user_id, bool set_inventory)
 				}
 
 				if (skill_nr == 14) {
-					skill_fed->setTiming(cycle, count, max_count, -1);
+					skill_fed->loadTiming(cycle, count, max_count);
 				}
 
 				if (skill_nr == 15) {
-					skill_light->setTiming(cycle, count, max_count, -1);
+					skill_light->loadTiming(cycle, count, max_count);
 				}
 
 				if (skill_nr == 17) {
-					skill_poison->setTiming(cycle, count, max_count, -1);
+					skill_poison->loadTiming(cycle, count, max_count);
 				}
 
 				if (skill_nr == 18) {
-					skill_burning->setTiming(cycle, count, max_count, -1);
+					skill_burning->loadTiming(cycle, count, max_count);
 				}
 
 				if (skill_nr == 19) {
-					skill_energy->setTiming(cycle, count, max_count, -1);
+					skill_energy->loadTiming(cycle, count, max_count);
 				}
 
 				if (skill_nr == 20) {
-					skill_drunken->setTiming(cycle, count, max_count, -1);
+					skill_drunken->loadTiming(cycle, count, max_count);
 				}
 
 				if (skill_nr == 21) {
-					skill_magic_shield->setTiming(cycle, count, max_count, -1);
+					skill_magic_shield->loadTiming(cycle, count, max_count);
 				}
 
 				if (skill_nr == 22) {
@@ -391,7 +391,7 @@ bool Player::loadData(uint32_t user_id, bool set_inventory)
 						if (script.getToken() == TOKEN_NUMBER) {
 							const uint16_t type_id = script.getNumber();
 							if (type_id != 0) {
-								Item* item = g_itempool.createItem(type_id);
+								Item* item = g_itempool.createItem(type_id, false);
 								if (!item) {
 									fmt::printf("ERROR - Player::loadData: invalid item (typeid:%d)\n", type_id);
 									return false;
@@ -399,7 +399,7 @@ bool Player::loadData(uint32_t user_id, bool set_inventory)
 
 								addObject(item, slot);
 
-								if (!item->loadData(script)) {
+								if (!item->loadData(script, false)) {
 									fmt::printf("ERROR - Player::loadData: failed to load item data (typeid:%d)\n", type_id);
 									return false;
 								}
@@ -1659,13 +1659,13 @@ void Player::onWalk(const Position& from_pos, int32_t from_index, const Position
 	const int32_t dz = std::abs(from_pos.z - to_pos.z);
 
 	if ((dx + 1) > 2 || (dy + 1) > 2 || (dz + 1) > 1) {
-		NetworkMessage msg;
+		NetworkMessage msg(MESSAGE_SIZE_LARGE);
 		Protocol::addMapDescription(connection_ptr, msg, to_pos);
-		connection_ptr->send(msg);
+		connection_ptr->send(std::move(msg));
 		return;
 	}
 
-	NetworkMessage msg;
+	NetworkMessage msg(MESSAGE_SIZE_MEDIUM);
 
 	// move self player
 	msg.writeByte(0x6D);
@@ -1764,7 +1764,7 @@ void Player::onWalk(const Position& from_pos, int32_t from_index, const Position
 		Protocol::addMapFloors(connection_ptr, msg, to_pos.x - 8, to_pos.y - 6, to_pos.z, 1, 14);
 	}
 
-	connection_ptr->send(msg);
+	connection_ptr->send(std::move(msg));
 }
 
 void Player::onKilledCreature(Creature* target)
@@ -8,16 +8,11 @@
 #include "item.h"
 #include "tools.h"
 #include "channels.h"
+#include "loginqueue.h"
+#include "telemetry.h"
 
 void Protocol::parseCharacterList(Connection_ptr connection, NetworkMessage& msg)
 {
-	msg.skipBytes(16);
-
-	if (!msg.rsaDecrypt()) {
-		connection->close();
-		return;
-	}
-
 	uint32_t symmetric_key[4];
 	symmetric_key[0] = msg.readQuad();
 	symmetric_key[1] = msg.readQuad();
@@ -41,20 +36,13 @@ void Protocol::parseCharacterList(Connection_ptr connection, NetworkMessage& msg
 	}
 
 	msg.readQuad();
-	msg.readString();
+	msg.readStringView();
 
 	sendCharacterList(connection);
 }
 
 void Protocol::parseCharacterLogin(Connection_ptr connection, NetworkMessage& msg)
 {
-	msg.skipBytes(4);
-
-	if (!msg.rsaDecrypt()) {
-		connection->close();
-		return;
-	}
-
 	uint32_t symmetric_key[4];
 	symmetric_key[0] = msg.readQuad();
 	symmetric_key[1] = msg.readQuad();
@@ -64,8 +52,8 @@ void Protocol::parseCharacterLogin(Connection_ptr connection, NetworkMessage& ms
 
 	msg.readByte();
 	const uint32_t account_number = msg.readQuad();
-	msg.readString();
-	msg.readString();
+	msg.readStringView();
+	msg.readStringView();
 
 	if (g_game.getGameState() == GAME_OFFLINE) {
 		sendLoginDisconnect(connection, 0x14, "The server is not online.\nPlease try again later.");
@@ -82,36 +70,7 @@ void Protocol::parseCharacterLogin(Connection_ptr connection, NetworkMessage& ms
 		return;
 	}
 
-	Player* player = g_game.getPlayerByUserId(account_number);
-	if (player == nullptr) {
-		player = g_game.getStoredPlayer(account_number);
-		if (player == nullptr) {
-			player = new Player();
-
-			if (!player->loadData(account_number)) {
-				delete player;
-				sendLoginDisconnect(connection, 0x14, "Invalid player data.");
-				return;
-			}
-
-			g_game.storePlayer(player, account_number);
-		}
-
-		Position pos = player->getPosition();
-
-		player->setConnection(connection);
-		connection->setPlayer(player);
-
-		if (!g_map.searchFreeField(player, pos, 1)) {
-			pos = g_game.getNewbieStart();
-		}
-
-		if (g_game.setCreatureOnMap(player, pos.x, pos.y, pos.z) != ALLGOOD) {
-			sendLoginDisconnect(connection, 0x14, "Invalid position for player.");
-		}
-	} else {
-		player->takeOver(connection);
-	}
+	g_loginqueue.addPlayer(connection, account_number);
 }
 
 void Protocol::parseCommand(Connection_ptr connection, NetworkMessage& msg)
@@ -133,10 +92,21 @@ void Protocol::parseCommand(Connection_ptr connection, NetworkMessage& msg)
 		return;
 	}
 
+	if (!connection->spendCommandBudget(g_config.CommandCost[command])) {
+		g_telemetry.addDroppedCommand(command);
+		// keep the client in sync with the server position when a step is dropped
+		if (command >= 100 && command <= 109 && command != 105) {
+			sendSnapback(connection);
+		}
+		return;
+	}
+
 	if (command != 30 && command != 105 && command != 190 && command != 202) {
 		player->timestamp_action = g_game.getRoundNr();
 	}
 
+	const auto start_time = std::chrono::steady_clock::now();
+
 	switch (command) {
 		case 20: parseLogout(connection, player); break;
 		case 30: parsePing(connection, player); break;
@@ -198,6 +168,9 @@ void Protocol::parseCommand(Connection_ptr connection, NetworkMessage& msg)
 			fmt::printf("INFO - Protocol::ParseCommand: %s sent unknown command (%d)\n", player->getName(), command);
 			break;
 	}
+
+	// walking and other queued actions run later from the creature's to do list and are not included
+	g_telemetry.addCommand(command, msg.getLength(), std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count());
 }
 
 void Protocol::parseLogout(Connection_ptr connection, Player* player)
@@ -489,7 +462,7 @@ void Protocol::parseLookAtPoint(Connection_ptr connection, Player* player, Netwo
 
 void Protocol::parseTalk(Connection_ptr connection, Player* player, NetworkMessage& msg)
 {
-	std::string address;
+	std::string_view address;
 	uint16_t channel_id;
 
 	const TalkType_t type = static_cast<TalkType_t>(msg.readByte());
@@ -497,7 +470,7 @@ void Protocol::parseTalk(Connection_ptr connection, Player* player, NetworkMessa
 		case TALKTYPE_PRIVATE:
 		case TALKTYPE_PRIVATE_RED:
 		case TALKTYPE_RVR_ANSWER:
-			address = msg.readString();
+			address = msg.readStringView();
 			channel_id = 0;
 			break;
 
@@ -512,9 +485,10 @@ void Protocol::parseTalk(Connection_ptr connection, Player* player, NetworkMessa
 			break;
 	}
 
-	const std::string text = msg.readString();
+	// both views point into msg, toDoTalk copies them
+	const std::string_view text = msg.readStringView();
 	if (text.length() > 255) {
-		fmt::printf("INFO - Protocol::ParseTalk: %s sent a big text message: '%s'.\n", text);
+		fmt::printf("INFO - Protocol::ParseTalk: %s sent a big text message: '%s'.\n", player->getName(), text);
 		return;
 	}
 
@@ -697,53 +671,69 @@ void Protocol::parseErrorFileEntry(Connection_ptr connection, Player* player, Ne
 void Protocol::addCreature(Connection_ptr connection, NetworkMessage& msg, const Creature* creature, bool is_known, uint32_t old_creature, bool update_follows)
 {
 	if (update_follows) {
-		msg.writeWord(0x63);
-		msg.writeQuad(creature->getId());
-		msg.writeByte(creature->getLookDirection());
+		msg.writeRecord<7>([creature](MessageWriter& writer) {
+			writer.addWord(0x63);
+			writer.addQuad(creature->getId());
+			writer.addByte(creature->getLookDirection());
+		});
 		return;
-	} else if (is_known) {
-		msg.writeWord(0x62);
-		msg.writeQuad(creature->getId());
-	} else {
-		msg.writeWord(0x61);
-		msg.writeQuad(old_creature);
-		msg.writeQuad(creature->getId());
-		msg.writeString(creature->getName());
 	}
 
-	msg.writeByte(100);
-	msg.writeByte(creature->getLookDirection());
+	const Player* player = connection->getPlayer();
+	const std::string& name = creature->getName();
 
-	addOutfit(msg, creature->getCurrentOutfit());
+	// longest layout: unknown creature with a full outfit
+	msg.writeReserved(26 + name.size(), [&](MessageWriter& writer) {
+		if (is_known) {
+			writer.addWord(0x62);
+			writer.addQuad(creature->getId());
+		} else {
+			writer.addWord(0x61);
+			writer.addQuad(old_creature);
+			writer.addQuad(creature->getId());
+			writer.addString(name);
+		}
 
-	uint8_t brightness, color;
-	creature->getLight(brightness, color);
-	msg.writeByte(brightness);
-	msg.writeByte(color);
+		writer.addByte(100);
+		writer.addByte(creature->getLookDirection());
 
-	msg.writeWord(creature->getSpeed());
+		addOutfit(writer, creature->getCurrentOutfit());
 
-	Player* player = connection->getPlayer();
-	if (const Player* other_player = creature->getPlayer()) {
-		msg.writeByte(other_player->getKillingMark(player));
-		msg.writeByte(other_player->getPartyMark(player));
-	} else {
-		msg.writeByte(0x00);
-		msg.writeByte(0x00);
-	}
+		uint8_t brightness, color;
+		creature->getLight(brightness, color);
+		writer.addByte(brightness);
+		writer.addByte(color);
+
+		writer.addWord(creature->getSpeed());
+
+		if (const Player* other_player = creature->getPlayer()) {
+			writer.addByte(other_player->getKillingMark(player));
+			writer.addByte(other_player->getPartyMark(player));
+		} else {
+			writer.addByte(0x00);
+			writer.addByte(0x00);
+		}
+	});
 }
 
 void Protocol::addOutfit(NetworkMessage& msg, const Outfit& outfit)
 {
-	msg.writeWord(outfit.look_id);
+	msg.writeReserved(6, [&outfit](MessageWriter& writer) {
+		addOutfit(writer, outfit);
+	});
+}
+
+void Protocol::addOutfit(MessageWriter& writer, const Outfit& outfit)
+{
+	writer.addWord(outfit.look_id);
 
 	if (outfit.look_id) {
-		msg.writeByte(outfit.head);
-		msg.writeByte(outfit.body);
-		msg.writeByte(outfit.legs);
-		msg.writeByte(outfit.feet);
+		writer.addByte(outfit.head);
+		writer.addByte(outfit.body);
+		writer.addByte(outfit.legs);
+		writer.addByte(outfit.feet);
 	} else {
-		msg.writeWord(outfit.type_id);
+		writer.addWord(outfit.type_id);
 	}
 }
 
@@ -754,23 +744,32 @@ void Protocol::addPosition(NetworkMessage& msg, const Position& position)
 
 void Protocol::addPosition(NetworkMessage& msg, int32_t x, int32_t y, int32_t z)
 {
-	msg.writeWord(x);
-	msg.writeWord(y);
-	msg.writeByte(z);
+	msg.writeRecord<5>([x, y, z](MessageWriter& writer) {
+		writer.addWord(x);
+		writer.addWord(y);
+		writer.addByte(z);
+	});
 }
 
 void Protocol::addItem(NetworkMessage& msg, const Item* item)
+{
+	msg.writeReserved(3, [item](MessageWriter& writer) {
+		addItem(writer, item);
+	});
+}
+
+void Protocol::addItem(MessageWriter& writer, const Item* item)
 {
 	if (item->getFlag(DISGUISE)) {
-		msg.writeWord(item->getAttribute(DISGUISETARGET));
+		writer.addWord(item->getAttribute(DISGUISETARGET));
 	} else {
-		msg.writeWord(item->getId());
+		writer.addWord(item->getId());
 	}
 
 	if (item->getFlag(CUMULATIVE)) {
-		msg.writeByte(item->getAttribute(ITEM_AMOUNT));
+		writer.addByte(item->getAttribute(ITEM_AMOUNT));
 	} else if (item->getFlag(LIQUIDCONTAINER) || item->getFlag(LIQUIDPOOL)) {
-		msg.writeByte(getLiquidColor(item->getAttribute(ITEM_LIQUID_TYPE)));
+		writer.addByte(getLiquidColor(item->getAttribute(ITEM_LIQUID_TYPE)));
 	}
 }
 
@@ -792,7 +791,7 @@ void Protocol::sendLoginDisconnect(Connection_ptr connection, uint8_t protocol,
 	NetworkMessage msg;
 	msg.writeByte(protocol);
 	msg.writeString(text);
-	connection->send(msg);
+	connection->send(std::move(msg));
 	connection->close(false);
 }
 
@@ -810,7 +809,7 @@ void Protocol::sendCharacterList(Connection_ptr connection)
 	msg.writeQuad(inet_addr("127.0.0.1"));
 	msg.writeWord(7171);
 	msg.writeWord(0x00);
-	connection->send(msg);
+	connection->send(std::move(msg));
 	connection->close(false);
 }
 
@@ -822,13 +821,13 @@ void Protocol::sendInitGame(Connection_ptr connection)
 
 	const Player* player = connection->getPlayer();
 
-	NetworkMessage msg;
+	NetworkMessage msg(MESSAGE_SIZE_LARGE);
 	msg.writeByte(0x0A);
 	msg.writeQuad(player->getId());
 	msg.writeWord(g_config.Beat);
 	msg.writeByte(0x01); // Can report bugs?
 	addMapDescription(connection, msg, player->getPosition());
-	connection->send(msg);
+	connection->send(std::move(msg));
 
 	if (Item* item = player->getInventoryItem(INVENTORY_HEAD)) {
 		Protocol::sendSetInventory(connection, INVENTORY_HEAD, item);
@@ -880,7 +879,7 @@ void Protocol::sendPing(Connection_ptr connection)
 
 	NetworkMessage msg;
 	msg.writeByte(0x1E);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendStats(Connection_ptr connection)
@@ -892,23 +891,25 @@ void Protocol::sendStats(Connection_ptr connection)
 	const Player* player = connection->getPlayer();
 
 	NetworkMessage msg;
-	msg.writeByte(0xA0);
-	msg.writeWord(player->skill_hitpoints->getValue());
-	msg.writeWord(player->skill_hitpoints->getMax());
-	msg.writeWord(static_cast<uint16_t>(std::max<uint16_t>(0, player->getFreeCapacity() / 100)));
-	if (player->skill_experience[SKILL_LEVEL] >= std::numeric_limits<uint32_t>::max() - 1) {
-		msg.writeQuad(0);
-	} else {
-		msg.writeQuad(std::min<uint32_t>(std::numeric_limits<uint32_t>::max(), player->skill_experience[SKILL_LEVEL]));
-	}
-	msg.writeWord(player->skill_level[SKILL_LEVEL]);
-	msg.writeByte(player->skill_percent[SKILL_LEVEL]);
-	msg.writeWord(player->skill_manapoints->getValue());
-	msg.writeWord(player->skill_manapoints->getMax());
-	msg.writeByte(player->skill_level[SKILL_MAGIC]);
-	msg.writeByte(player->skill_percent[SKILL_MAGIC]); 
-	msg.writeByte(player->skill_soulpoints->getSoulpoints());
-	connection->send(msg);
+	msg.writeRecord<21>([player](MessageWriter& writer) {
+		writer.addByte(0xA0);
+		writer.addWord(player->skill_hitpoints->getValue());
+		writer.addWord(player->skill_hitpoints->getMax());
+		writer.addWord(static_cast<uint16_t>(std::max<uint16_t>(0, player->getFreeCapacity() / 100)));
+		if (player->skill_experience[SKILL_LEVEL] >= std::numeric_limits<uint32_t>::max() - 1) {
+			writer.addQuad(0);
+		} else {
+			writer.addQuad(std::min<uint32_t>(std::numeric_limits<uint32_t>::max(), player->skill_experience[SKILL_LEVEL]));
+		}
+		writer.addWord(player->skill_level[SKILL_LEVEL]);
+		writer.addByte(player->skill_percent[SKILL_LEVEL]);
+		writer.addWord(player->skill_manapoints->getValue());
+		writer.addWord(player->skill_manapoints->getMax());
+		writer.addByte(player->skill_level[SKILL_MAGIC]);
+		writer.addByte(player->skill_percent[SKILL_MAGIC]);
+		writer.addByte(player->skill_soulpoints->getSoulpoints());
+	});
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendSkills(Connection_ptr connection)
@@ -919,23 +920,20 @@ void Protocol::sendSkills(Connection_ptr connection)
 
 	const Player* player = connection->getPlayer();
 
+	static constexpr SkillType_t skills[] = {
+		SKILL_FISTFIGHTING, SKILL_CLUBFIGHTING, SKILL_SWORDFIGHTING, SKILL_AXEFIGHTING,
+		SKILL_DISTANCEFIGHTING, SKILL_SHIELDING, SKILL_FISHING
+	};
+
 	NetworkMessage msg;
-	msg.writeByte(0xA1);
-	msg.writeByte(player->skill_level[SKILL_FISTFIGHTING]);
-	msg.writeByte(player->skill_percent[SKILL_FISTFIGHTING]);
-	msg.writeByte(player->skill_level[SKILL_CLUBFIGHTING]);
-	msg.writeByte(player->skill_percent[SKILL_CLUBFIGHTING]);
-	msg.writeByte(player->skill_level[SKILL_SWORDFIGHTING]);
-	msg.writeByte(player->skill_percent[SKILL_SWORDFIGHTING]);
-	msg.writeByte(player->skill_level[SKILL_AXEFIGHTING]);
-	msg.writeByte(player->skill_percent[SKILL_AXEFIGHTING]);
-	msg.writeByte(player->skill_level[SKILL_DISTANCEFIGHTING]);
-	msg.writeByte(player->skill_percent[SKILL_DISTANCEFIGHTING]);
-	msg.writeByte(player->skill_level[SKILL_SHIELDING]);
-	msg.writeByte(player->skill_percent[SKILL_SHIELDING]);
-	msg.writeByte(player->skill_level[SKILL_FISHING]);
-	msg.writeByte(player->skill_percent[SKILL_FISHING]);
-	connection->send(msg);
+	msg.writeRecord<1 + sizeof(skills) / sizeof(skills[0]) * 2>([player](MessageWriter& writer) {
+		writer.addByte(0xA1);
+		for (const SkillType_t skill : skills) {
+			writer.addByte(player->skill_level[skill]);
+			writer.addByte(player->skill_percent[skill]);
+		}
+	});
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendSnapback(Connection_ptr connection)
@@ -947,7 +945,7 @@ void Protocol::sendSnapback(Connection_ptr connection)
 	NetworkMessage msg;
 	msg.writeByte(0xB5);
 	msg.writeByte(connection->getPlayer()->getLookDirection());
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendOutfitWindow(Connection_ptr connection)
@@ -971,7 +969,7 @@ void Protocol::sendOutfitWindow(Connection_ptr connection)
 		msg.writeWord(142);
 	}
 
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendSetInventory(Connection_ptr connection, uint8_t slot, const Item * item)
@@ -984,7 +982,7 @@ void Protocol::sendSetInventory(Connection_ptr connection, uint8_t slot, const I
 	msg.writeByte(0x78);
 	msg.writeByte(slot);
 	addItem(msg, item);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendDeleteInventory(Connection_ptr connection, uint8_t slot)
@@ -996,7 +994,7 @@ void Protocol::sendDeleteInventory(Connection_ptr connection, uint8_t slot)
 	NetworkMessage msg;
 	msg.writeByte(0x79);
 	msg.writeByte(slot);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendTextMessage(Connection_ptr connection, uint8_t type, const std::string& text)
@@ -1009,7 +1007,7 @@ void Protocol::sendTextMessage(Connection_ptr connection, uint8_t type, const st
 	msg.writeByte(0xB4);
 	msg.writeByte(type);
 	msg.writeString(text);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendResult(Connection_ptr connection, ReturnValue_t ret)
@@ -1027,7 +1025,7 @@ void Protocol::sendEditText(Connection_ptr connection, const Item* item, uint32_
 		return;
 	}
 
-	NetworkMessage msg;
+	NetworkMessage msg(MESSAGE_SIZE_MEDIUM);
 	msg.writeByte(0x96);
 	msg.writeQuad(edit_text_id);
 	addItem(msg, item);
@@ -1058,7 +1056,7 @@ void Protocol::sendEditText(Connection_ptr connection, const Item* item, uint32_
 		msg.writeString(item->getEditor());
 	}
 
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendPlayerState(Connection_ptr connection, uint8_t state)
@@ -1070,7 +1068,7 @@ void Protocol::sendPlayerState(Connection_ptr connection, uint8_t state)
 	NetworkMessage msg;
 	msg.writeByte(0xA2);
 	msg.writeByte(state);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendClearTarget(Connection_ptr connection)
@@ -1081,7 +1079,7 @@ void Protocol::sendClearTarget(Connection_ptr connection)
 
 	NetworkMessage msg;
 	msg.writeByte(0xA3);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendMarkCreature(Connection_ptr connection, uint32_t creature_id, uint8_t color)
@@ -1094,7 +1092,7 @@ void Protocol::sendMarkCreature(Connection_ptr connection, uint32_t creature_id,
 	msg.writeByte(0x86);
 	msg.writeQuad(creature_id);
 	msg.writeByte(color);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendTradeItemRequest(Connection_ptr connection, const std::string& name, const Item* item, bool acknowledge)
@@ -1103,7 +1101,7 @@ void Protocol::sendTradeItemRequest(Connection_ptr connection, const std::string
 		return;
 	}
 
-	NetworkMessage msg;
+	NetworkMessage msg(MESSAGE_SIZE_MEDIUM);
 
 	if (acknowledge) {
 		msg.writeByte(0x7D);
@@ -1142,7 +1140,7 @@ void Protocol::sendTradeItemRequest(Connection_ptr connection, const std::string
 		addItem(msg, item);
 	}
 
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendTradeClose(Connection_ptr connection)
@@ -1153,7 +1151,7 @@ void Protocol::sendTradeClose(Connection_ptr connection)
 
 	NetworkMessage msg;
 	msg.writeByte(0x7F);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendChannels(Connection_ptr connection, const std::vector<const Channel*>& channels)
@@ -1162,7 +1160,7 @@ void Protocol::sendChannels(Connection_ptr connection, const std::vector<const C
 		return;
 	}
 
-	NetworkMessage msg;
+	NetworkMessage msg(MESSAGE_SIZE_MEDIUM);
 	msg.writeByte(0xAB);
 	msg.writeByte(channels.size());
 	for (const Channel* channel : channels) {
@@ -1174,7 +1172,7 @@ void Protocol::sendChannels(Connection_ptr connection, const std::vector<const C
 			msg.writeString(channel->getName());
 		}
 	}
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendChannel(Connection_ptr connection, const Channel* channel)
@@ -1187,7 +1185,7 @@ void Protocol::sendChannel(Connection_ptr connection, const Channel* channel)
 	msg.writeByte(0xAC);
 	msg.writeWord(channel->getId());
 	msg.writeString(channel->getName());
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendPrivateChannel(Connection_ptr connection, const std::string& address)
@@ -1199,7 +1197,7 @@ void Protocol::sendPrivateChannel(Connection_ptr connection, const std::string&
 	NetworkMessage msg;
 	msg.writeByte(0xAD);
 	msg.writeString(address);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendOpenOwnChannel(Connection_ptr connection, const Channel* channel)
@@ -1216,7 +1214,7 @@ void Protocol::sendOpenOwnChannel(Connection_ptr connection, const Channel* chan
 	} else {
 		msg.writeString(channel->getName());
 	}
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendCloseChannel(Connection_ptr connection, const Channel* channel)
@@ -1228,7 +1226,7 @@ void Protocol::sendCloseChannel(Connection_ptr connection, const Channel* channe
 	NetworkMessage msg;
 	msg.writeByte(0xB3);
 	msg.writeWord(channel->getId());
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendLockRuleViolation(Connection_ptr connection)
@@ -1239,7 +1237,7 @@ void Protocol::sendLockRuleViolation(Connection_ptr connection)
 
 	NetworkMessage msg;
 	msg.writeByte(0xB1);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendRuleViolationChannel(Connection_ptr connection, uint16_t channel_id)
@@ -1248,7 +1246,7 @@ void Protocol::sendRuleViolationChannel(Connection_ptr connection, uint16_t chan
 		return;
 	}
 
-	NetworkMessage msg;
+	NetworkMessage msg(MESSAGE_SIZE_MEDIUM);
 	msg.writeByte(0xAE);
 	msg.writeWord(channel_id);
 	for (const auto it : g_game.getRuleViolationReports()) {
@@ -1262,7 +1260,7 @@ void Protocol::sendRuleViolationChannel(Connection_ptr connection, uint16_t chan
 			msg.writeString(entry.text);
 		}
 	}
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendRemoveRuleViolationReport(Connection_ptr connection, const std::string& reporter)
@@ -1274,7 +1272,7 @@ void Protocol::sendRemoveRuleViolationReport(Connection_ptr connection, const st
 	NetworkMessage msg;
 	msg.writeByte(0xAF);
 	msg.writeString(reporter);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendRuleViolationCancel(Connection_ptr connection, const std::string& reporter)
@@ -1286,7 +1284,7 @@ void Protocol::sendRuleViolationCancel(Connection_ptr connection, const std::str
 	NetworkMessage msg;
 	msg.writeByte(0xB0);
 	msg.writeString(reporter);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendTalk(Connection_ptr connection, uint32_t statement_id, const std::string& sender, TalkType_t type, uint16_t channel_id, const std::string& text)
@@ -1302,7 +1300,10 @@ void Protocol::sendTalk(Connection_ptr connection, uint32_t statement_id, const
 	msg.writeByte(type);
 	msg.writeWord(channel_id);
 	msg.writeString(text);
-	connection->send(msg);
+
+	// red channel messages come from gamemasters and are never shed
+	const bool red = type == TALKTYPE_CHANNEL_R1 || type == TALKTYPE_CHANNEL_R2;
+	connection->send(std::move(msg), red ? MESSAGE_CLASS_CRITICAL : MESSAGE_CLASS_CHAT);
 }
 
 void Protocol::sendTalk(Connection_ptr connection, uint32_t statement_id, const std::string& sender, TalkType_t type, const std::string& text, uint32_t data)
@@ -1322,7 +1323,7 @@ void Protocol::sendTalk(Connection_ptr connection, uint32_t statement_id, const
 	}
 
 	msg.writeString(text);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendTalk(Connection_ptr connection, uint32_t statement_id, const std::string& sender, TalkType_t type, const std::string& text, const Position& pos)
@@ -1338,7 +1339,7 @@ void Protocol::sendTalk(Connection_ptr connection, uint32_t statement_id, const
 	msg.writeByte(type);
 	addPosition(msg, pos);
 	msg.writeString(text);
-	connection->send(msg);
+	connection->send(std::move(msg), MESSAGE_CLASS_CHAT);
 }
 
 void Protocol::sendContainer(Connection_ptr connection, uint8_t container_id, const Item* item)
@@ -1347,7 +1348,7 @@ void Protocol::sendContainer(Connection_ptr connection, uint8_t container_id, co
 		return;
 	}
 
-	NetworkMessage msg;
+	NetworkMessage msg(MESSAGE_SIZE_MEDIUM);
 	msg.writeByte(0x6E);
 	msg.writeByte(container_id);
 	addItem(msg, item);
@@ -1370,7 +1371,7 @@ void Protocol::sendContainer(Connection_ptr connection, uint8_t container_id, co
 		id++;
 	}
 
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendCloseContainer(Connection_ptr connection, uint8_t container_id)
@@ -1382,7 +1383,7 @@ void Protocol::sendCloseContainer(Connection_ptr connection, uint8_t container_i
 	NetworkMessage msg;
 	msg.writeByte(0x6F);
 	msg.writeByte(container_id);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendCreateInContainer(Connection_ptr connection, uint8_t container_id, const Item* item)
@@ -1395,7 +1396,7 @@ void Protocol::sendCreateInContainer(Connection_ptr connection, uint8_t containe
 	msg.writeByte(0x70);
 	msg.writeByte(container_id);
 	addItem(msg, item);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendChangeInContainer(Connection_ptr connection, uint8_t container_id, uint8_t index, const Item* item)
@@ -1409,7 +1410,7 @@ void Protocol::sendChangeInContainer(Connection_ptr connection, uint8_t containe
 	msg.writeByte(container_id);
 	msg.writeByte(index);
 	addItem(msg, item);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendDeleteInContainer(Connection_ptr connection, uint8_t container_id, uint8_t index)
@@ -1422,7 +1423,7 @@ void Protocol::sendDeleteInContainer(Connection_ptr connection, uint8_t containe
 	msg.writeByte(0x72);
 	msg.writeByte(container_id);
 	msg.writeByte(index);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::addMapDescription(Connection_ptr connection, NetworkMessage& msg, const Position& position)
@@ -1452,8 +1453,7 @@ void Protocol::addMapFloors(Connection_ptr connection, NetworkMessage& msg, int3
 	}
 
 	if (skip >= 0) {
-		msg.writeByte(skip);
-		msg.writeByte(0xFF);
+		addSkipTiles(msg, skip);
 	}
 }
 
@@ -1464,15 +1464,13 @@ void Protocol::addMapRow(Connection_ptr connection, NetworkMessage& msg, int32_t
 			Tile* tile = g_map.getTile(x + nx + offset, y + ny + offset, z);
 			if (tile) {
 				if (skip >= 0) {
-					msg.writeByte(skip);
-					msg.writeByte(0xFF);
+					addSkipTiles(msg, skip);
 				}
 
 				skip = 0;
 				addMapPoint(connection, msg, tile);
 			} else if (skip == 0xFE) {
-				msg.writeByte(0xFF);
-				msg.writeByte(0xFF);
+				addSkipTiles(msg, 0xFF);
 				skip = -1;
 			} else {
 				++skip;
@@ -1481,16 +1479,54 @@ void Protocol::addMapRow(Connection_ptr connection, NetworkMessage& msg, int32_t
 	}
 }
 
+void Protocol::addSkipTiles(NetworkMessage& msg, uint8_t count)
+{
+	msg.writeRecord<2>([count](MessageWriter& writer) {
+		writer.addByte(count);
+		writer.addByte(0xFF);
+	});
+}
+
 void Protocol::addMapPoint(Connection_ptr connection, NetworkMessage& msg, const Tile* tile)
 {
+	if (!tile->encoding_valid) {
+		encodeMapPoint(tile);
+	}
+
+	const uint8_t* encoded_items = tile->encoded_items.data();
+
+	uint16_t offset = 0;
+	for (const auto& it : tile->encoded_creatures) {
+		msg.writeBytes(encoded_items + offset, it.first - offset);
+		offset = it.first;
+		addMapObject(connection, msg, it.second);
+	}
+
+	msg.writeBytes(encoded_items + offset, tile->encoded_items.size() - offset);
+}
+
+void Protocol::encodeMapPoint(const Tile* tile)
+{
+	NetworkMessage msg;
+
+	tile->encoded_creatures.clear();
+
 	uint8_t count = 0;
-	for (Object* object : tile->getObjects()) {
+	for (const Object* object : tile->getObjects()) {
 		count++;
-		addMapObject(connection, msg, object);
+		if (const Item* item = object->getItem()) {
+			addItem(msg, item);
+		} else if (object->getCreature()) {
+			tile->encoded_creatures.emplace_back(msg.getLength(), object);
+		}
+
 		if (count == 10) {
 			break;
 		}
 	}
+
+	tile->encoded_items.assign(msg.getBodyBuffer(), msg.getBodyBuffer() + msg.getLength());
+	tile->encoding_valid = true;
 }
 
 void Protocol::addMapObject(Connection_ptr connection, NetworkMessage& msg, const Object* object, bool update)
@@ -1500,7 +1536,7 @@ void Protocol::addMapObject(Connection_ptr connection, NetworkMessage& msg, cons
 	} else if (const Creature* creature = object->getCreature()) {
 		bool is_known = false;
 		uint32_t removed_id = 0;
-		connection->checkCreatureID(creature->getId(), is_known, removed_id);
+		connection->checkCreatureID(creature, is_known, removed_id);
 		addCreature(connection, msg, creature, is_known, removed_id, update);
 	}
 }
@@ -1526,7 +1562,7 @@ void Protocol::sendMoveCreature(Connection_ptr connection, const Creature* creat
 			addPosition(msg, from_pos);
 			msg.writeByte(from_index);
 			addPosition(msg, to_pos);
-			connection->send(msg);
+			connection->send(std::move(msg), MESSAGE_CLASS_MOVEMENT);
 		}
 	} else if (player->canSeePosition(from_pos)) {
 		sendDeleteField(connection, from_pos, from_index);
@@ -1548,7 +1584,7 @@ void Protocol::sendAmbiente(Connection_ptr connection)
 	msg.writeByte(0x82);
 	msg.writeByte(brightness);
 	msg.writeByte(color);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendRefreshField(Connection_ptr connection, const Tile * tile)
@@ -1570,7 +1606,7 @@ void Protocol::sendRefreshField(Connection_ptr connection, const Tile * tile)
 		msg.writeByte(0xFF);
 	}
 
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendAddField(Connection_ptr connection, const Object* object)
@@ -1580,10 +1616,14 @@ void Protocol::sendAddField(Connection_ptr connection, const Object* object)
 	}
 
 	NetworkMessage msg;
-	msg.writeByte(0x6A);
-	addPosition(msg, object->getPosition());
-	addMapObject(connection, msg, object);
-	connection->send(msg);
+	if (const Item* item = object->getItem()) {
+		addAddField(msg, item);
+	} else {
+		msg.writeByte(0x6A);
+		addPosition(msg, object->getPosition());
+		addMapObject(connection, msg, object);
+	}
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendDeleteField(Connection_ptr connection, const Position& position, int32_t index)
@@ -1593,10 +1633,8 @@ void Protocol::sendDeleteField(Connection_ptr connection, const Position& positi
 	}
 
 	NetworkMessage msg;
-	msg.writeByte(0x6C);
-	addPosition(msg, position);
-	msg.writeByte(index);
-	connection->send(msg);
+	addDeleteField(msg, position, index);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendChangeField(Connection_ptr connection, Object* object)
@@ -1611,11 +1649,37 @@ void Protocol::sendChangeField(Connection_ptr connection, Object* object)
 	}
 
 	NetworkMessage msg;
+	if (const Item* item = object->getItem()) {
+		addChangeField(msg, item, index);
+	} else {
+		msg.writeByte(0x6B);
+		addPosition(msg, object->getPosition());
+		msg.writeByte(index);
+		addMapObject(connection, msg, object, true);
+	}
+	connection->send(std::move(msg));
+}
+
+void Protocol::addAddField(NetworkMessage& msg, const Item* item)
+{
+	msg.writeByte(0x6A);
+	addPosition(msg, item->getPosition());
+	addItem(msg, item);
+}
+
+void Protocol::addChangeField(NetworkMessage& msg, const Item* item, int32_t index)
+{
 	msg.writeByte(0x6B);
-	addPosition(msg, object->getPosition());
+	addPosition(msg, item->getPosition());
+	msg.writeByte(index);
+	addItem(msg, item);
+}
+
+void Protocol::addDeleteField(NetworkMessage& msg, const Position& position, int32_t index)
+{
+	msg.writeByte(0x6C);
+	addPosition(msg, position);
 	msg.writeByte(index);
-	addMapObject(connection, msg, object, true);
-	connection->send(msg);
 }
 
 void Protocol::sendCreatureOutfit(Connection_ptr connection, const Creature * creature)
@@ -1628,7 +1692,7 @@ void Protocol::sendCreatureOutfit(Connection_ptr connection, const Creature * cr
 	msg.writeByte(0x8E);
 	msg.writeQuad(creature->getId());
 	addOutfit(msg, creature->getCurrentOutfit());
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendCreatureHealth(Connection_ptr connection, const Creature* creature)
@@ -1641,7 +1705,7 @@ void Protocol::sendCreatureHealth(Connection_ptr connection, const Creature* cre
 	msg.writeByte(0x8C);
 	msg.writeQuad(creature->getId());
 	msg.writeByte(getPercentToGo(creature->getHitpoints(), creature->getMaxHitpoints()));
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendCreatureLight(Connection_ptr connection, const Creature* creature)
@@ -1657,7 +1721,7 @@ void Protocol::sendCreatureLight(Connection_ptr connection, const Creature* crea
 	creature->getLight(brightness, color);
 	msg.writeByte(brightness);
 	msg.writeByte(color);
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendCreatureSpeed(Connection_ptr connection, const Creature* creature)
@@ -1670,7 +1734,7 @@ void Protocol::sendCreatureSpeed(Connection_ptr connection, const Creature* crea
 	msg.writeByte(0x8F);
 	msg.writeQuad(creature->getId());
 	msg.writeWord(creature->getSpeed());
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendCreatureSkull(Connection_ptr connection, const Creature* creature)
@@ -1685,7 +1749,7 @@ void Protocol::sendCreatureSkull(Connection_ptr connection, const Creature* crea
 	msg.writeByte(0x90);
 	msg.writeQuad(creature->getId());
 	msg.writeByte(player->getKillingMark(connection->getPlayer()));
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendCreatureParty(Connection_ptr connection, const Creature* creature)
@@ -1698,7 +1762,7 @@ void Protocol::sendCreatureParty(Connection_ptr connection, const Creature* crea
 	msg.writeByte(0x91);
 	msg.writeQuad(creature->getId());
 	msg.writeByte(connection->getPlayer()->getPartyMark(creature->getPlayer()));
-	connection->send(msg);
+	connection->send(std::move(msg));
 }
 
 void Protocol::sendGraphicalEffect(Connection_ptr connection, int32_t x, int32_t y, int32_t z, uint8_t type)
@@ -1708,10 +1772,8 @@ void Protocol::sendGraphicalEffect(Connection_ptr connection, int32_t x, int32_t
 	}
 
 	NetworkMessage msg;
-	msg.writeByte(0x83);
-	addPosition(msg, x, y, z);
-	msg.writeByte(type);
-	connection->send(msg);
+	addGraphicalEffect(msg, x, y, z, type);
+	connection->send(std::move(msg), MESSAGE_CLASS_COSMETIC);
 }
 
 void Protocol::sendMissile(Connection_ptr connection, const Position& from_pos, const Position& to_pos, uint8_t type)
@@ -1721,11 +1783,8 @@ void Protocol::sendMissile(Connection_ptr connection, const Position& from_pos,
 	}
 
 	NetworkMessage msg;
-	msg.writeByte(0x85);
-	addPosition(msg, from_pos);
-	addPosition(msg, to_pos);
-	msg.writeByte(type);
-	connection->send(msg);
+	addMissile(msg, from_pos, to_pos, type);
+	connection->send(std::move(msg), MESSAGE_CLASS_COSMETIC);
 }
 
 void Protocol::sendAnimatedText(Connection_ptr connection, const Position& pos, uint8_t color, const std::string& text)
@@ -1735,9 +1794,38 @@ void Protocol::sendAnimatedText(Connection_ptr connection, const Position& pos,
 	}
 
 	NetworkMessage msg;
+	addAnimatedText(msg, pos, color, text);
+	connection->send(std::move(msg), MESSAGE_CLASS_COSMETIC);
+}
+
+void Protocol::sendShared(Connection_ptr connection, const NetworkMessage& msg, MessageClass_t type)
+{
+	if (!connection) {
+		return;
+	}
+
+	connection->sendShared(msg, type);
+}
+
+void Protocol::addGraphicalEffect(NetworkMessage& msg, int32_t x, int32_t y, int32_t z, uint8_t type)
+{
+	msg.writeByte(0x83);
+	addPosition(msg, x, y, z);
+	msg.writeByte(type);
+}
+
+void Protocol::addMissile(NetworkMessage& msg, const Position& from_pos, const Position& to_pos, uint8_t type)
+{
+	msg.writeByte(0x85);
+	addPosition(msg, from_pos);
+	addPosition(msg, to_pos);
+	msg.writeByte(type);
+}
+
+void Protocol::addAnimatedText(NetworkMessage& msg, const Position& pos, uint8_t color, const std::string& text)
+{
 	msg.writeByte(0x84);
 	addPosition(msg, pos);
 	msg.writeByte(color);
 	msg.writeString(text);
-	connection->send(msg);
 }
@@ -68,9 +68,11 @@ public:
 
 	static void addCreature(Connection_ptr connection, NetworkMessage& msg, const Creature* creature, bool IsKnown, uint32_t OldCreature, bool UpdateFollows = false);
 	static void addOutfit(NetworkMessage& msg, const Outfit& Outfit);
+	static void addOutfit(MessageWriter& writer, const Outfit& outfit);
 	static void addPosition(NetworkMessage& msg, const Position& Position);
 	static void addPosition(NetworkMessage& msg, int32_t x, int32_t y, int32_t z);
 	static void addItem(NetworkMessage& msg, const Item* Item);
+	static void addItem(MessageWriter& writer, const Item* item);
 
 	static Position readPosition(NetworkMessage& msg);
 
@@ -122,7 +124,9 @@ public:
 	static void addMapDescription(Connection_ptr connection, NetworkMessage& msg, const Position& Position);
 	static void addMapFloors(Connection_ptr connection, NetworkMessage& msg, int32_t x, int32_t y, int32_t z, int32_t width, int32_t height);
 	static void addMapRow(Connection_ptr connection, NetworkMessage& msg, int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, int32_t offset, int32_t& skip);
+	static void addSkipTiles(NetworkMessage& msg, uint8_t count);
 	static void addMapPoint(Connection_ptr connection, NetworkMessage& msg, const Tile* Tile);
+	static void encodeMapPoint(const Tile* tile);
 	static void addMapObject(Connection_ptr connection, NetworkMessage& msg, const Object* object, bool Update = false);
 
 	static void sendMoveCreature(Connection_ptr connection, const Creature* creature, const Position& from_pos, int32_t from_index, const Position& to_pos, int32_t to_index);
@@ -132,6 +136,10 @@ public:
 	static void sendAddField(Connection_ptr connection, const Object* object);
 	static void sendDeleteField(Connection_ptr connection, const Position& Position, int32_t index);
 	static void sendChangeField(Connection_ptr connection, Object* object);
+
+	static void addAddField(NetworkMessage& msg, const Item* item);
+	static void addChangeField(NetworkMessage& msg, const Item* item, int32_t index);
+	static void addDeleteField(NetworkMessage& msg, const Position& position, int32_t index);
 	
 	static void sendCreatureOutfit(Connection_ptr connection, const Creature* creature);
 	static void sendCreatureHealth(Connection_ptr connection, const Creature* creature);
@@ -143,4 +151,11 @@ public:
 	static void sendGraphicalEffect(Connection_ptr connection, int32_t x, int32_t y, int32_t z, uint8_t type);
 	static void sendMissile(Connection_ptr connection, const Position& from_pos, const Position& to_pos, uint8_t type);
 	static void sendAnimatedText(Connection_ptr connection, const Position& pos, uint8_t color, const std::string& text);
+
+	// messages encoded once and copied to every spectator
+	static void sendShared(Connection_ptr connection, const NetworkMessage& msg, MessageClass_t type = MESSAGE_CLASS_CRITICAL);
+
+	static void addGraphicalEffect(NetworkMessage& msg, int32_t x, int32_t y, int32_t z, uint8_t type);
+	static void addMissile(NetworkMessage& msg, const Position& from_pos, const Position& to_pos, uint8_t type);
+	static void addAnimatedText(NetworkMessage& msg, const Position& pos, uint8_t color, const std::string& text);
 };
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "pch.h"
+
+#include "replay.h"
+#include "game.h"
+#include "loginqueue.h"
+#include "taskpool.h"
+#include "config.h"
+
+bool Replay::load(const std::string& filename)
+{
+	FILE* file = fopen(filename.c_str(), "rb");
+	if (!file) {
+		fmt::printf("ERROR - Replay::load: cannot open %s.\n", filename);
+		return false;
+	}
+
+	uint32_t magic = 0;
+	uint16_t version = 0;
+	if (fread(&magic, sizeof(magic), 1, file) != 1 || fread(&version, sizeof(version), 1, file) != 1 ||
+		fread(&beat, sizeof(beat), 1, file) != 1 || fread(&seed, sizeof(seed), 1, file) != 1 ||
+		fread(&start_time, sizeof(start_time), 1, file) != 1) {
+		fmt::printf("ERROR - Replay::load: %s is truncated.\n", filename);
+		fclose(file);
+		return false;
+	}
+
+	if (magic != CAPTURE_MAGIC || version != CAPTURE_VERSION) {
+		fmt::printf("ERROR - Replay::load: %s is not a capture of this version.\n", filename);
+		fclose(file);
+		return false;
+	}
+
+	while (true) {
+		ReplayRecord record;
+		uint16_t size = 0;
+		if (fread(&record.type, sizeof(record.type), 1, file) != 1 || fread(&record.beat, sizeof(record.beat), 1, file) != 1 ||
+			fread(&record.connection_id, sizeof(record.connection_id), 1, file) != 1 || fread(&size, sizeof(size), 1, file) != 1) {
+			break;
+		}
+
+		record.data.resize(size);
+		if (size != 0 && fread(record.data.data(), 1, size, file) != size) {
+			fmt::printf("INFO - Replay::load: %s ends in the middle of a record.\n", filename);
+			break;
+		}
+
+		records.emplace_back(std::move(record));
+	}
+
+	fclose(file);
+
+	if (beat != g_config.Beat) {
+		fmt::printf("INFO - Replay::load: captured with a beat of %d ms, config has %d ms.\n", beat, g_config.Beat);
+	}
+
+	fmt::printf(">> Loaded %d capture records.\n", records.size());
+	return true;
+}
+
+void Replay::run()
+{
+	using clock = std::chrono::steady_clock;
+
+	if (records.empty()) {
+		return;
+	}
+
+	g_game.setGameState(GAME_RUNNING);
+
+	uint64_t milliseconds = start_time;
+	g_game.resetClock(milliseconds);
+	const uint32_t first_beat = records.front().beat;
+	const uint32_t last_beat = records.back().beat;
+	beat_times.reserve(last_beat - first_beat + 1);
+
+	size_t next_record = 0;
+	for (uint32_t beat_nr = first_beat; next_record < records.size(); beat_nr++) {
+		const clock::time_point start = clock::now();
+
+		// records written by the I/O threads may be slightly out of order, anything not newer belongs here
+		bool logins = false;
+		while (next_record < records.size() && records[next_record].beat <= beat_nr) {
+			logins |= records[next_record].type == CAPTURE_RECORD_LOGIN;
+			feedRecord(records[next_record++]);
+		}
+
+		// player files load on g_taskpool, wait so they are admitted in this beat on every run
+		if (logins) {
+			g_taskpool.wait();
+		}
+
+		milliseconds += g_config.Beat;
+		g_game.runBeat(milliseconds);
+
+		beat_times.push_back(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count());
+	}
+
+	printStatistics();
+}
+
+void Replay::feedRecord(const ReplayRecord& record)
+{
+	if (record.type == CAPTURE_RECORD_LOGIN) {
+		if (record.data.size() != sizeof(uint32_t)) {
+			return;
+		}
+
+		Connection_ptr& connection = connections[record.connection_id];
+		if (!connection) {
+			connection = std::make_shared<Connection>(io_service, true);
+			g_game.addConnection(connection);
+		}
+
+		uint32_t user_id;
+		memcpy(&user_id, record.data.data(), sizeof(user_id));
+		g_loginqueue.addPlayer(connection, user_id);
+		return;
+	}
+
+	const auto it = connections.find(record.connection_id);
+	if (it == connections.end()) {
+		return;
+	}
+
+	Connection_ptr connection = it->second;
+	if (record.type == CAPTURE_RECORD_CLOSE) {
+		connections.erase(it);
+		connection->close();
+		g_game.removeConnection(connection);
+		return;
+	}
+
+	// same layout as a decrypted frame: inner length followed by the body
+	const uint16_t size = static_cast<uint16_t>(record.data.size());
+	NetworkMessage msg(MessagePool::getSizeClass(size + NetworkMessage::HEADER_LENGTH + NetworkMessage::XTEA_MULTIPLE));
+	uint8_t* buffer = msg.getBuffer();
+	buffer[0] = static_cast<uint8_t>(size);
+	buffer[1] = static_cast<uint8_t>(size >> 8);
+	memcpy(buffer + NetworkMessage::HEADER_LENGTH, record.data.data(), size);
+	msg.setLength(size + NetworkMessage::HEADER_LENGTH);
+	connection->replayData(std::move(msg));
+}
+
+void Replay::printStatistics() const
+{
+	static constexpr std::array<int64_t, 8> bucket_limits = { 1000, 2000, 5000, 10000, 20000, 50000, 100000, std::numeric_limits<int64_t>::max() };
+
+	if (beat_times.empty()) {
+		return;
+	}
+
+	std::array<uint64_t, bucket_limits.size()> buckets{};
+	int64_t total_time = 0;
+	for (const int64_t time : beat_times) {
+		total_time += time;
+		buckets[std::lower_bound(bucket_limits.begin(), bucket_limits.end(), time + 1) - bucket_limits.begin()]++;
+	}
+
+	std::vector<int64_t> sorted_times = beat_times;
+	std::sort(sorted_times.begin(), sorted_times.end());
+	const auto percentile = [&sorted_times](size_t percent) {
+		return sorted_times[(sorted_times.size() - 1) * percent / 100] / 1000.0;
+	};
+
+	fmt::printf(">> Replayed %d beats, %.2f ms average, %.2f ms median, %.2f ms p99, %.2f ms max.\n", beat_times.size(),
+		total_time / 1000.0 / beat_times.size(), percentile(50), percentile(99), sorted_times.back() / 1000.0);
+
+	int64_t lower_limit = 0;
+	for (size_t i = 0; i < buckets.size(); i++) {
+		if (bucket_limits[i] == std::numeric_limits<int64_t>::max()) {
+			fmt::printf(">>   >= %3d ms: %d\n", lower_limit / 1000, buckets[i]);
+		} else {
+			fmt::printf(">>   <  %3d ms: %d\n", bucket_limits[i] / 1000, buckets[i]);
+		}
+		lower_limit = bucket_limits[i];
+	}
+}
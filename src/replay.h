@@ -0,0 +1,42 @@
+#pragma once
+
+#include "capture.h"
+#include "connection.h"
+
+struct ReplayRecord
+{
+	CaptureRecord_t type = CAPTURE_RECORD_PACKET;
+	uint32_t beat = 0;
+	uint32_t connection_id = 0;
+	std::vector<uint8_t> data;
+};
+
+// Boots without sockets and feeds a file written by Capture back beat by beat through
+// headless connections, the game clock advances one beat per round so runs are repeatable.
+class Replay
+{
+public:
+	explicit Replay() = default;
+
+	Replay(const Replay&) = delete;
+	Replay& operator=(const Replay&) = delete;
+
+	bool load(const std::string& filename);
+	void run();
+
+	uint32_t getSeed() const {
+		return seed;
+	}
+private:
+	void feedRecord(const ReplayRecord& record);
+	void printStatistics() const;
+
+	boost::asio::io_service io_service;
+	std::vector<ReplayRecord> records;
+	std::unordered_map<uint32_t, Connection_ptr> connections;
+	std::vector<int64_t> beat_times;
+
+	uint64_t start_time = 0;
+	uint32_t seed = 0;
+	uint16_t beat = 0;
+};
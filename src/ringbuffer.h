@@ -0,0 +1,51 @@
+#pragma once
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+template<typename T, size_t Capacity>
+class RingBuffer
+{
+	static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "RingBuffer capacity must be a power of two");
+public:
+	explicit RingBuffer() = default;
+
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	// producer side
+	bool push(T&& value) {
+		const size_t tail = write_index.load(std::memory_order_relaxed);
+		if (tail - read_index.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+
+		slots[tail & (Capacity - 1)] = std::move(value);
+		write_index.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool full() const {
+		return write_index.load(std::memory_order_relaxed) - read_index.load(std::memory_order_acquire) == Capacity;
+	}
+
+	// consumer side
+	bool empty() const {
+		return read_index.load(std::memory_order_relaxed) == write_index.load(std::memory_order_acquire);
+	}
+
+	T& front() {
+		return slots[read_index.load(std::memory_order_relaxed) & (Capacity - 1)];
+	}
+
+	void pop() {
+		const size_t head = read_index.load(std::memory_order_relaxed);
+
+		// release whatever the slot holds right away instead of when it is overwritten
+		T released(std::move(slots[head & (Capacity - 1)]));
+		read_index.store(head + 1, std::memory_order_release);
+	}
+private:
+	std::array<T, Capacity> slots;
+
+	alignas(64) std::atomic<size_t> read_index{ 0 };
+	alignas(64) std::atomic<size_t> write_index{ 0 };
+};
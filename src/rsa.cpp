@@ -2,23 +2,50 @@
 
 #include "rsa.h"
 
+// per thread scratch numbers so decrypting does not initialize and clear integers every call
+struct RSAScratch
+{
+	RSAScratch() {
+		mpz_init2(c, 1024);
+		mpz_init2(m1, 1024);
+		mpz_init2(m2, 1024);
+		mpz_init2(h, 1024);
+	}
+	~RSAScratch() {
+		mpz_clear(c);
+		mpz_clear(m1);
+		mpz_clear(m2);
+		mpz_clear(h);
+	}
+
+	mpz_t c, m1, m2, h;
+};
+
 TRSA::TRSA()
 {
 	mpz_init(n);
 	mpz_init2(d, 1024);
+	mpz_init2(p, 512);
+	mpz_init2(q, 512);
+	mpz_init2(dp, 512);
+	mpz_init2(dq, 512);
+	mpz_init2(qinv, 512);
 }
 
 TRSA::~TRSA()
 {
 	mpz_clear(n);
 	mpz_clear(d);
+	mpz_clear(p);
+	mpz_clear(q);
+	mpz_clear(dp);
+	mpz_clear(dq);
+	mpz_clear(qinv);
 }
 
 void TRSA::setKey(const char* pString, const char* qString)
 {
-	mpz_t p, q, e;
-	mpz_init2(p, 1024);
-	mpz_init2(q, 1024);
+	mpz_t e;
 	mpz_init(e);
 
 	mpz_set_str(p, pString, 10);
@@ -44,30 +71,38 @@ void TRSA::setKey(const char* pString, const char* qString)
 	// d = e^-1 mod (p - 1)(q - 1)
 	mpz_invert(d, e, pq_1);
 
+	// dp = d mod (p - 1), dq = d mod (q - 1), qinv = q^-1 mod p
+	mpz_mod(dp, d, p_1);
+	mpz_mod(dq, d, q_1);
+	mpz_invert(qinv, q, p);
+
 	mpz_clear(p_1);
 	mpz_clear(q_1);
 	mpz_clear(pq_1);
 
-	mpz_clear(p);
-	mpz_clear(q);
 	mpz_clear(e);
 }
 
 void TRSA::decrypt(char* msg) const
 {
-	mpz_t c, m;
-	mpz_init2(c, 1024);
-	mpz_init2(m, 1024);
+	thread_local RSAScratch scratch;
 
-	mpz_import(c, 128, 1, 1, 0, 0, msg);
+	mpz_import(scratch.c, 128, 1, 1, 0, 0, msg);
 
-	// m = c^d mod n
-	mpz_powm(m, c, d, n);
+	// m1 = c^dp mod p, m2 = c^dq mod q
+	mpz_powm(scratch.m1, scratch.c, dp, p);
+	mpz_powm(scratch.m2, scratch.c, dq, q);
 
-	uint32_t amount = (mpz_sizeinbase(m, 2) + 7) / 8;
-	memset(msg, 0, 128 - amount);
-	mpz_export(msg + (128 - amount), nullptr, 1, 1, 0, 0, m);
+	// h = qinv * (m1 - m2) mod p
+	mpz_sub(scratch.h, scratch.m1, scratch.m2);
+	mpz_mul(scratch.h, scratch.h, qinv);
+	mpz_mod(scratch.h, scratch.h, p);
 
-	mpz_clear(c);
-	mpz_clear(m);
+	// m = m2 + h * q
+	mpz_mul(scratch.h, scratch.h, q);
+	mpz_add(scratch.m1, scratch.m2, scratch.h);
+
+	uint32_t amount = (mpz_sizeinbase(scratch.m1, 2) + 7) / 8;
+	memset(msg, 0, 128 - amount);
+	mpz_export(msg + (128 - amount), nullptr, 1, 1, 0, 0, scratch.m1);
 }
@@ -2,6 +2,10 @@
 
 #include <gmp.h>
 
+// private key matching the public key compiled into the 7.72 client, shared by the game server and the login gateway
+static constexpr const char* RSA_PRIME_P = "14299623962416399520070177382898895550795403345466153217470516082934737582776038882967213386204600674145392845853859217990626450972452084065728686565928113";
+static constexpr const char* RSA_PRIME_Q = "7630979195970404721891201847792002125535401292779123937207447574596692788513647179235335529307251350570728407373705564708871762033017096809910315212884101";
+
 class TRSA
 {
 public:
@@ -9,10 +13,15 @@ public:
 	~TRSA();
 
 	void setKey(const char* pString, const char* qString);
+
+	// safe to call from several threads at once
 	void decrypt(char* msg) const;
 private:
 	//use only GMP
 	mpz_t n, d;
+
+	// chinese remainder theorem parameters
+	mpz_t p, q, dp, dq, qinv;
 };
 
-extern TRSA RSA;
\ No newline at end of file
+extern TRSA RSA;
@@ -1,33 +1,251 @@
 #include "pch.h"
 
 #include "server.h"
-#include "game.h"
 
-void Server::open()
+#ifdef SO_REUSEPORT
+using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+Server::~Server()
 {
-	accept();
+	close();
+	join();
+
+	// idle sockets go while their io_service exists, the pending handlers destroyed with the
+	// io_services release the remaining connections into pools that are still alive
+	acceptors.clear();
+	timing_wheels.clear();
+	for (auto& connection_pool : connection_pools) {
+		connection_pool->shutdown();
+	}
+	io_works.clear();
+	io_services.clear();
+	connection_pools.clear();
+}
+
+bool Server::open()
+{
+	const uint32_t thread_count = std::max<uint32_t>(1, g_config.IOThreads);
+
+	bool reuse_port = g_config.ReusePort && thread_count > 1;
+#ifndef SO_REUSEPORT
+	if (reuse_port) {
+		fmt::printf("INFO - Server::open: SO_REUSEPORT is not supported on this platform, using a single acceptor.\n");
+		reuse_port = false;
+	}
+#endif
+
+	for (uint32_t i = 0; i < thread_count; i++) {
+		io_services.emplace_back(new boost::asio::io_service(1));
+		io_works.emplace_back(new boost::asio::io_service::work(*io_services.back()));
+		timing_wheels.emplace_back(new TimingWheel(*io_services.back()));
+		connection_pools.emplace_back(new ConnectionPool(*io_services.back()));
+	}
+
+	try {
+		if (reuse_port) {
+			for (auto& io_service : io_services) {
+				acceptors.push_back(createAcceptor(*io_service, true));
+			}
+		} else {
+			acceptors.push_back(createAcceptor(*io_services.front(), false));
+		}
+	} catch (boost::system::system_error& e) {
+		fmt::printf("ERROR - Server::open: %s.\n", e.what());
+		acceptors.clear();
+		connection_pools.clear();
+		timing_wheels.clear();
+		io_works.clear();
+		io_services.clear();
+		return false;
+	}
+
+	acceptor_per_service = reuse_port;
+
+	for (size_t i = 0; i < acceptors.size(); i++) {
+		accept(i);
+	}
+
+	for (auto& timing_wheel : timing_wheels) {
+		timing_wheel->start();
+	}
+
+	for (auto& io_service : io_services) {
+		boost::asio::io_service* service = io_service.get();
+		io_threads.emplace_back([service]() {
+			service->run();
+		});
+	}
+
+	fmt::printf(">> Network running on %d thread(s) with %d acceptor(s).\n", io_threads.size(), acceptors.size());
+	return true;
 }
 
 void Server::close()
 {
-	acceptor.close();
+	for (Acceptor_ptr& acceptor : acceptors) {
+		boost::system::error_code error;
+		acceptor->close(error);
+	}
+
+	for (auto& timing_wheel : timing_wheels) {
+		timing_wheel->stop();
+	}
+
+	io_works.clear();
+	for (auto& io_service : io_services) {
+		io_service->stop();
+	}
+}
+
+void Server::join()
+{
+	for (std::thread& thread : io_threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+	io_threads.clear();
 }
 
-void Server::accept()
+void Server::printStatistics() const
 {
-	auto connection = std::make_shared<Connection>(io_service);
-	acceptor.async_accept(connection->getSocket(), std::bind(&Server::onAccept, this, connection, std::placeholders::_1));
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	for (const auto& connection_pool : connection_pools) {
+		hits += connection_pool->getHits();
+		misses += connection_pool->getMisses();
+	}
+
+	const double hit_rate = hits + misses != 0 ? static_cast<double>(hits) / (hits + misses) : 0.0;
+	fmt::printf(">> Connection pool hit rate: %.2f%% (%d hits, %d misses).\n", hit_rate * 100, hits, misses);
+	fmt::printf(">> Rejected connections: %d over the per IP limit, %d over the accept rate.\n", rejected_by_cap.load(), rejected_by_rate.load());
 }
 
-void Server::onAccept(Connection_ptr Connection, const boost::system::error_code& error)
+bool Server::admitAddress(uint32_t address)
+{
+	// local tools such as the load generator open many connections on purpose
+	if (address == 0 || (address >> 24) == 127) {
+		return true;
+	}
+
+	const int64_t tick = TimingWheel::getTick();
+
+	std::lock_guard<std::mutex> lockClass(address_mutex);
+
+	// forget idle addresses once per second so the table only holds recent hosts
+	if (tick != address_sweep_tick) {
+		address_sweep_tick = tick;
+		for (auto it = addresses.begin(); it != addresses.end();) {
+			if (it->second.connections == 0 && it->second.accept_tick != tick) {
+				it = addresses.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	AddressEntry& entry = addresses[address];
+	if (entry.accept_tick != tick) {
+		entry.accept_tick = tick;
+		entry.accepts = 0;
+	}
+
+	if (g_config.AcceptRatePerIP != 0 && entry.accepts >= g_config.AcceptRatePerIP) {
+		if (rejected_by_rate++ == 0) {
+			fmt::printf("INFO - Server::admitAddress: %s exceeded the accept rate, rejecting connections.\n", boost::asio::ip::address_v4(address).to_string());
+		}
+		return false;
+	}
+	entry.accepts++;
+
+	if (g_config.MaxConnectionsPerIP != 0 && entry.connections >= g_config.MaxConnectionsPerIP) {
+		if (rejected_by_cap++ == 0) {
+			fmt::printf("INFO - Server::admitAddress: %s reached the connection limit, rejecting connections.\n", boost::asio::ip::address_v4(address).to_string());
+		}
+		return false;
+	}
+	entry.connections++;
+	return true;
+}
+
+void Server::releaseAddress(uint32_t address)
+{
+	if (address == 0 || (address >> 24) == 127) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lockClass(address_mutex);
+
+	auto it = addresses.find(address);
+	if (it != addresses.end() && it->second.connections != 0) {
+		it->second.connections--;
+	}
+}
+
+Server::Acceptor_ptr Server::createAcceptor(boost::asio::io_service& io_service, bool reuse_port)
+{
+	const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address(boost::asio::ip::address_v4::from_string(g_config.IP)), g_config.Port);
+
+	Acceptor_ptr acceptor(new boost::asio::ip::tcp::acceptor(io_service));
+	acceptor->open(endpoint.protocol());
+	acceptor->set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+#ifdef SO_REUSEPORT
+	if (reuse_port) {
+		acceptor->set_option(::reuse_port(true));
+	}
+#endif
+	acceptor->set_option(boost::asio::ip::tcp::no_delay(true));
+	acceptor->bind(endpoint);
+	acceptor->listen();
+	return acceptor;
+}
+
+size_t Server::getNextService()
+{
+	return next_service++ % io_services.size();
+}
+
+void Server::accept(size_t acceptor_index)
+{
+	const size_t service_index = acceptor_per_service ? acceptor_index : getNextService();
+
+	Connection_ptr connection = connection_pools[service_index]->acquireConnection();
+	acceptors[acceptor_index]->async_accept(connection->getSocket(), std::bind(&Server::onAccept, this, acceptor_index, service_index, connection, std::placeholders::_1));
+}
+
+void Server::onAccept(size_t acceptor_index, size_t service_index, Connection_ptr Connection, const boost::system::error_code& error)
 {
 	if (error == boost::asio::error::operation_aborted) {
 		return;
 	}
 
-	g_game.addConnection(Connection);
-	Connection->receiveData();
+	if (!error) {
+		boost::system::error_code endpoint_error;
+		const boost::asio::ip::tcp::endpoint endpoint = Connection->getSocket().remote_endpoint(endpoint_error);
+
+		uint32_t address = 0;
+		if (!endpoint_error && endpoint.address().is_v4()) {
+			address = endpoint.address().to_v4().to_uint();
+		}
+
+		if (endpoint_error || !admitAddress(address)) {
+			// the socket goes back to the pool closed, nothing of it ever reaches the game
+			Connection->closeSocket();
+			accept(acceptor_index);
+			return;
+		}
+
+		Connection->setAddress(address);
+
+		// the first read has to be issued from the thread owning the connection
+		TimingWheel* timing_wheel = timing_wheels[service_index].get();
+		boost::asio::post(Connection->getSocket().get_executor(), [timing_wheel, Connection]() {
+			timing_wheel->addConnection(Connection);
+			Connection->receiveData();
+		});
+	}
 
 	// accept next incoming Connection
-	accept();
-}
\ No newline at end of file
+	accept(acceptor_index);
+}
@@ -1,23 +1,75 @@
 #pragma once
 
-#include "Connection.h"
+#include "connection.h"
+#include "timingwheel.h"
+#include "connectionpool.h"
 #include "config.h"
 
 class Server
 {
 public:
-	explicit Server(boost::asio::io_service& ioservice) :
-		io_service(ioservice),
-		acceptor(ioservice, boost::asio::ip::tcp::endpoint(boost::asio::ip::address(boost::asio::ip::address_v4::from_string(g_config.IP)), g_config.Port)) {
-		acceptor.set_option(boost::asio::ip::tcp::no_delay(true));
-	}
+	explicit Server() = default;
+	~Server();
+
+	Server(const Server&) = delete;
+	Server& operator=(const Server&) = delete;
 
-	void open();
+	bool open();
 	void close();
+	void join();
+
+	// called once for every connection admitted by onAccept when it closes
+	void releaseAddress(uint32_t address);
+
+	uint64_t getRejectedByCap() const {
+		return rejected_by_cap;
+	}
+	uint64_t getRejectedByRate() const {
+		return rejected_by_rate;
+	}
+
+	void printStatistics() const;
 private:
-	boost::asio::io_service& io_service;
-	boost::asio::ip::tcp::acceptor acceptor;
+	struct AddressEntry
+	{
+		uint32_t connections = 0;
+		uint32_t accepts = 0;
+		int64_t accept_tick = 0;
+	};
+
+	using Acceptor_ptr = std::unique_ptr<boost::asio::ip::tcp::acceptor>;
+
+	Acceptor_ptr createAcceptor(boost::asio::io_service& io_service, bool reuse_port);
+	size_t getNextService();
+
+	void accept(size_t acceptor_index);
+	void onAccept(size_t acceptor_index, size_t service_index, Connection_ptr Connection, const boost::system::error_code& error);
+	bool admitAddress(uint32_t address);
+
+	// one io_service per thread, a connection stays on the service it was accepted for
+	std::vector<std::unique_ptr<boost::asio::io_service>> io_services;
+	std::vector<std::unique_ptr<boost::asio::io_service::work>> io_works;
+	std::vector<std::thread> io_threads;
+
+	// recycled connections of each io_service, outlive the connections still held by pending handlers
+	std::vector<std::unique_ptr<ConnectionPool>> connection_pools;
+
+	// timeouts of the connections of each io_service, swept by its own thread
+	std::vector<std::unique_ptr<TimingWheel>> timing_wheels;
+
+	// either a single acceptor or one SO_REUSEPORT acceptor per io_service
+	std::vector<Acceptor_ptr> acceptors;
+	bool acceptor_per_service = false;
+
+	std::atomic<uint32_t> next_service{ 0 };
+
+	// open connections and accepts of the current second per remote IPv4 address, shared by all acceptors
+	std::mutex address_mutex;
+	std::unordered_map<uint32_t, AddressEntry> addresses;
+	int64_t address_sweep_tick = 0;
+
+	std::atomic<uint64_t> rejected_by_cap{ 0 };
+	std::atomic<uint64_t> rejected_by_rate{ 0 };
+};
 
-	void accept();
-	void onAccept(Connection_ptr Connection, const boost::system::error_code& error);
-};
\ No newline at end of file
+extern Server g_server;
@@ -0,0 +1,48 @@
+#include "pch.h"
+
+#include "status.h"
+#include "config.h"
+
+// config values end up in attribute values, a world name such as "Tom & Jerry" would break the document
+static std::string escapeXML(const std::string& text)
+{
+	std::string result;
+	result.reserve(text.size());
+	for (const char c : text) {
+		switch (c) {
+			case '&': result += "&amp;"; break;
+			case '<': result += "&lt;"; break;
+			case '>': result += "&gt;"; break;
+			case '"': result += "&quot;"; break;
+			case '\'': result += "&apos;"; break;
+			default: result += c; break;
+		}
+	}
+	return result;
+}
+
+bool Status::isStatusRequest(const uint8_t* body, uint16_t size)
+{
+	return size >= 6 && body[0] == 0xFF && body[1] == 0xFF && memcmp(body + 2, "info", 4) == 0;
+}
+
+void Status::publish(const StatusSnapshot& snapshot)
+{
+	players_peak = std::max(players_peak, snapshot.players_online);
+
+	auto new_response = std::make_shared<std::string>(fmt::format(
+		"<?xml version=\"1.0\"?>\n"
+		"<tsqp version=\"1.0\">"
+		"<serverinfo uptime=\"{}\" ip=\"{}\" servername=\"{}\" port=\"{}\" server=\"RealOTS\" client=\"7.72\"/>"
+		"<players online=\"{}\" max=\"{}\" peak=\"{}\"/>"
+		"<map name=\"{}\"/>"
+		"<round number=\"{}\"/>"
+		"</tsqp>\n",
+		snapshot.round_number, escapeXML(g_config.IP), escapeXML(g_config.World), g_config.Port,
+		snapshot.players_online, g_config.MaxPlayers, players_peak,
+		escapeXML(g_config.MapName),
+		snapshot.round_number));
+
+	std::lock_guard<std::mutex> lockClass(mutex);
+	response = std::move(new_response);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// what the game thread knows about the world, published once per second
+struct StatusSnapshot
+{
+	uint32_t players_online = 0;
+	// advances once per game second, so it doubles as the uptime
+	uint32_t round_number = 0;
+};
+
+// Answers status queries ("\xFF\xFFinfo" as the first packet of a connection) on the I/O threads.
+// The game thread renders the XML reply once per second, queries only copy the shared pointer.
+class Status
+{
+public:
+	explicit Status() = default;
+
+	Status(const Status&) = delete;
+	Status& operator=(const Status&) = delete;
+
+	static bool isStatusRequest(const uint8_t* body, uint16_t size);
+
+	// only from the game thread
+	void publish(const StatusSnapshot& snapshot);
+
+	// nullptr until the game thread published for the first time
+	std::shared_ptr<const std::string> getResponse() {
+		queries++;
+
+		std::lock_guard<std::mutex> lockClass(mutex);
+		return response;
+	}
+
+	uint64_t getQueries() const {
+		return queries;
+	}
+private:
+	uint32_t players_peak = 0;
+
+	std::mutex mutex;
+	std::shared_ptr<const std::string> response;
+
+	std::atomic<uint64_t> queries{ 0 };
+};
+
+extern Status g_status;
@@ -0,0 +1,90 @@
+#include "pch.h"
+
+#include "taskpool.h"
+
+TaskPool::~TaskPool()
+{
+	stop();
+}
+
+void TaskPool::start(uint32_t thread_count)
+{
+	if (!threads.empty()) {
+		fmt::printf("ERROR - TaskPool::start: pool already started.\n");
+		return;
+	}
+
+	running = true;
+	for (uint32_t i = 0; i < std::max<uint32_t>(1, thread_count); i++) {
+		threads.emplace_back(&TaskPool::threadMain, this);
+	}
+}
+
+void TaskPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+		running = false;
+	}
+	signal.notify_all();
+	idle_signal.notify_all();
+
+	for (std::thread& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+	threads.clear();
+	tasks.clear();
+}
+
+void TaskPool::addTask(Task task)
+{
+	{
+		std::lock_guard<std::mutex> lockClass(mutex);
+		if (!running) {
+			return;
+		}
+
+		tasks.emplace_back(std::move(task));
+	}
+	signal.notify_one();
+}
+
+void TaskPool::wait()
+{
+	std::unique_lock<std::mutex> lockClass(mutex);
+	idle_signal.wait(lockClass, [this]() {
+		return !running || (tasks.empty() && active == 0);
+	});
+}
+
+void TaskPool::threadMain()
+{
+	while (true) {
+		Task task;
+
+		{
+			std::unique_lock<std::mutex> lockClass(mutex);
+			signal.wait(lockClass, [this]() {
+				return !running || !tasks.empty();
+			});
+
+			if (!running) {
+				return;
+			}
+
+			task = std::move(tasks.front());
+			tasks.pop_front();
+			active++;
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lockClass(mutex);
+			active--;
+		}
+		idle_signal.notify_all();
+	}
+}
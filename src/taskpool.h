@@ -0,0 +1,34 @@
+#pragma once
+
+using Task = std::function<void()>;
+
+// Worker threads for blocking or expensive jobs that must not run on the game thread.
+// Jobs touching game state hand their result back through Game::addTask.
+class TaskPool
+{
+public:
+	explicit TaskPool() = default;
+	~TaskPool();
+
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+
+	void start(uint32_t thread_count);
+	void stop();
+
+	void addTask(Task task);
+	// blocks until every queued task has finished
+	void wait();
+private:
+	void threadMain();
+
+	std::vector<std::thread> threads;
+	std::deque<Task> tasks;
+	std::mutex mutex;
+	std::condition_variable signal;
+	std::condition_variable idle_signal;
+	uint32_t active = 0;
+	bool running = false;
+};
+
+extern TaskPool g_taskpool;
@@ -0,0 +1,186 @@
+#include "pch.h"
+
+#include "telemetry.h"
+#include "server.h"
+#include "taskpool.h"
+
+static const char* getCommandName(uint8_t command)
+{
+	switch (command) {
+		case 20: return "logout";
+		case 30: return "ping";
+		case 100: return "go path";
+		case 101: return "go north";
+		case 102: return "go east";
+		case 103: return "go south";
+		case 104: return "go west";
+		case 105: return "stop";
+		case 106: return "go northeast";
+		case 107: return "go southeast";
+		case 108: return "go southwest";
+		case 109: return "go northwest";
+		case 111: return "turn north";
+		case 112: return "turn east";
+		case 113: return "turn south";
+		case 114: return "turn west";
+		case 120: return "move object";
+		case 125: return "request trade";
+		case 126: return "inspect trade";
+		case 127: return "accept trade";
+		case 128: return "close trade";
+		case 130: return "use object";
+		case 131: return "use two objects";
+		case 132: return "use on creature";
+		case 133: return "turn object";
+		case 135: return "close container";
+		case 136: return "up container";
+		case 137: return "edit text";
+		case 140: return "look at point";
+		case 150: return "talk";
+		case 151: return "request channels";
+		case 152: return "join channel";
+		case 153: return "leave channel";
+		case 154: return "open private channel";
+		case 155: return "process report";
+		case 156: return "close report";
+		case 157: return "cancel report";
+		case 160: return "tactics";
+		case 161: return "attack";
+		case 162: return "follow";
+		case 163: return "invite to party";
+		case 164: return "join party";
+		case 165: return "revoke invitation";
+		case 166: return "pass leadership";
+		case 167: return "leave party";
+		case 170: return "open channel";
+		case 171: return "invite to channel";
+		case 172: return "exclude from channel";
+		case 190: return "cancel";
+		case 201: return "refresh tile";
+		case 210: return "request outfits";
+		case 211: return "set outfit";
+		case 230: return "bug report";
+		case 232: return "error file entry";
+		default: return "unknown";
+	}
+}
+
+void Telemetry::addCommand(uint8_t command, uint16_t bytes, int64_t time)
+{
+	CommandStatistics& statistics = commands[command];
+	statistics.count++;
+	statistics.bytes += bytes;
+	statistics.total_time += time;
+	statistics.max_time = std::max(statistics.max_time, time);
+
+	size_t bucket = 0;
+	for (int64_t microseconds = time / 1000; microseconds != 0 && bucket + 1 < TELEMETRY_HISTOGRAM_SIZE; microseconds >>= 1) {
+		bucket++;
+	}
+	statistics.histogram[bucket]++;
+}
+
+void Telemetry::addDroppedCommand(uint8_t command)
+{
+	commands[command].dropped++;
+}
+
+void Telemetry::addSent(uint8_t type, uint16_t bytes)
+{
+	SendStatistics& statistics = sent[type];
+	statistics.count++;
+	statistics.bytes += bytes;
+}
+
+void Telemetry::addShed(uint8_t type, uint16_t bytes)
+{
+	SendStatistics& statistics = sent[type];
+	statistics.shed++;
+	statistics.shed_bytes += bytes;
+}
+
+void Telemetry::addBeat(int64_t time)
+{
+	beats++;
+	beat_time += time;
+}
+
+void Telemetry::addSlowConsumer(SlowConsumerPolicy_t action)
+{
+	slow_consumers[action]++;
+}
+
+std::string Telemetry::format() const
+{
+	std::string text;
+
+	text += fmt::sprintf("beats: %d, %.3f ms average\n", beats, beats != 0 ? beat_time / 1e6 / beats : 0.0);
+	text += fmt::sprintf("rejected connections: %d over the per IP limit, %d over the accept rate\n", g_server.getRejectedByCap(), g_server.getRejectedByRate());
+	text += fmt::sprintf("slow consumers: %d warned, %d shed, %d disconnected\n\n", slow_consumers[SLOW_CONSUMER_WARN], slow_consumers[SLOW_CONSUMER_SHED], slow_consumers[SLOW_CONSUMER_DISCONNECT]);
+
+	// the histogram columns are upper bounds in microseconds
+	text += fmt::sprintf("%-3s %-20s %10s %8s %12s %10s %10s %7s", "op", "command", "count", "dropped", "bytes", "avg us", "max us", "beat%");
+	for (size_t i = 0; i + 1 < TELEMETRY_HISTOGRAM_SIZE; i++) {
+		text += fmt::sprintf(" %7s", fmt::format("<{}", 1 << i));
+	}
+	text += fmt::sprintf(" %7s\n", fmt::format(">={}", 1 << (TELEMETRY_HISTOGRAM_SIZE - 2)));
+
+	for (size_t command = 0; command < commands.size(); command++) {
+		const CommandStatistics& statistics = commands[command];
+		if (statistics.count == 0 && statistics.dropped == 0) {
+			continue;
+		}
+
+		text += fmt::sprintf("%-3d %-20s %10d %8d %12d %10.2f %10.2f %6.2f%%", command, getCommandName(static_cast<uint8_t>(command)),
+			statistics.count, statistics.dropped, statistics.bytes,
+			statistics.count != 0 ? statistics.total_time / 1e3 / statistics.count : 0.0, statistics.max_time / 1e3,
+			beat_time != 0 ? statistics.total_time * 100.0 / beat_time : 0.0);
+		for (uint64_t bucket : statistics.histogram) {
+			text += fmt::sprintf(" %7d", bucket);
+		}
+		text += fmt::sprintf("\n");
+	}
+
+	text += fmt::sprintf("\n%-4s %10s %12s %8s %12s\n", "type", "count", "bytes", "shed", "shed bytes");
+	for (size_t type = 0; type < sent.size(); type++) {
+		const SendStatistics& statistics = sent[type];
+		if (statistics.count == 0 && statistics.shed == 0) {
+			continue;
+		}
+
+		text += fmt::sprintf("0x%02X %10d %12d %8d %12d\n", type, statistics.count, statistics.bytes, statistics.shed, statistics.shed_bytes);
+	}
+
+	return text;
+}
+
+bool Telemetry::dump(const std::string& filename) const
+{
+	return write(filename, format());
+}
+
+void Telemetry::dumpAsync(const std::string& filename)
+{
+	// a write still in flight means the disk is slower than the interval, skip this one
+	if (writing.exchange(true)) {
+		return;
+	}
+
+	g_taskpool.addTask([this, filename, text = format()]() {
+		write(filename, text);
+		writing = false;
+	});
+}
+
+bool Telemetry::write(const std::string& filename, const std::string& text)
+{
+	FILE* file = fopen(filename.c_str(), "wb");
+	if (!file) {
+		fmt::printf("ERROR - Telemetry::write: cannot create %s.\n", filename);
+		return false;
+	}
+
+	fwrite(text.data(), 1, text.size(), file);
+	fclose(file);
+	return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "config.h"
+
+static constexpr size_t TELEMETRY_HISTOGRAM_SIZE = 16;
+
+struct CommandStatistics
+{
+	uint64_t count = 0;
+	uint64_t dropped = 0;
+	uint64_t bytes = 0;
+	int64_t total_time = 0;
+	int64_t max_time = 0;
+
+	// bucket i counts calls that took less than 2^i microseconds, the last one everything slower
+	std::array<uint64_t, TELEMETRY_HISTOGRAM_SIZE> histogram{};
+};
+
+struct SendStatistics
+{
+	uint64_t count = 0;
+	uint64_t bytes = 0;
+	uint64_t shed = 0;
+	uint64_t shed_bytes = 0;
+};
+
+// Per opcode counters of client commands and server messages, written to g_config.StatsFile.
+// Only touched by the game thread, except for the file write of dumpAsync; times are in nanoseconds.
+class Telemetry
+{
+public:
+	explicit Telemetry() = default;
+
+	Telemetry(const Telemetry&) = delete;
+	Telemetry& operator=(const Telemetry&) = delete;
+
+	void addCommand(uint8_t command, uint16_t bytes, int64_t time);
+	void addDroppedCommand(uint8_t command);
+	void addSent(uint8_t type, uint16_t bytes);
+	void addShed(uint8_t type, uint16_t bytes);
+	void addBeat(int64_t time);
+	void addSlowConsumer(SlowConsumerPolicy_t action);
+
+	const CommandStatistics& getCommandStatistics(uint8_t command) const {
+		return commands[command];
+	}
+
+	std::string format() const;
+	// dump writes on the calling thread, dumpAsync formats here and leaves the file to g_taskpool
+	bool dump(const std::string& filename) const;
+	void dumpAsync(const std::string& filename);
+private:
+	static bool write(const std::string& filename, const std::string& text);
+
+	std::array<CommandStatistics, 256> commands;
+	std::array<SendStatistics, 256> sent;
+
+	uint64_t beats = 0;
+	int64_t beat_time = 0;
+
+	std::array<uint64_t, SLOW_CONSUMER_COUNT> slow_consumers{};
+
+	std::atomic<bool> writing{ false };
+};
+
+extern Telemetry g_telemetry;
@@ -97,6 +97,7 @@ Cylinder* Tile::queryDestination(int32_t& index, const Object* object, Item** to
 void Tile::addObject(Object* object, int32_t index)
 {
 	object->parent = this;
+	encoding_valid = false;
 
 	if (Item* item = object->getItem()) {
 		// only allow 1 magic field 
@@ -137,6 +138,8 @@ void Tile::removeObject(Object* object)
 		return;
 	}
 
+	encoding_valid = false;
+
 	object->parent = nullptr;
 	objects.erase(it);
 }
@@ -60,6 +60,11 @@ public:
 	Item* getLiquidPoolItem() const;
 
 	Creature* getTopCreature() const;
+
+	// called whenever the wire encoding of an item on the tile changes
+	void invalidateEncoding() {
+		encoding_valid = false;
+	}
 protected: 
 	Position current_position;
 
@@ -69,5 +74,12 @@ protected:
 
 	std::list<Object*> objects;
 
+	// wire encoding of the items among the first 10 objects, built by Protocol::addMapPoint,
+	// creatures depend on the viewer and are spliced in at their byte offsets
+	mutable std::vector<uint8_t> encoded_items;
+	mutable std::vector<std::pair<uint16_t, const Object*>> encoded_creatures;
+	mutable bool encoding_valid = false;
+
 	friend class Map;
+	friend class Protocol;
 };
@@ -0,0 +1,73 @@
+#include "pch.h"
+
+#include "timingwheel.h"
+
+void TimingWheel::start()
+{
+	last_tick = getTick();
+
+	timer.expires_from_now(boost::posix_time::seconds(1));
+	timer.async_wait(std::bind(&TimingWheel::sweep, this, std::placeholders::_1));
+}
+
+void TimingWheel::stop()
+{
+	boost::system::error_code error;
+	timer.cancel(error);
+}
+
+void TimingWheel::addConnection(const Connection_ptr& connection)
+{
+	// the deadline is looked up again when the slot comes around
+	slots[(getTick() + CONNECTION_READ_TIMEOUT) % TIMING_WHEEL_SLOTS].emplace_back(connection);
+}
+
+void TimingWheel::sweep(const boost::system::error_code& error)
+{
+	if (error == boost::asio::error::operation_aborted) {
+		return;
+	}
+
+	// catch up on the slots passed while the thread was busy, at most one full turn
+	const int64_t tick = getTick();
+	for (int64_t i = std::max<int64_t>(last_tick + 1, tick - TIMING_WHEEL_SLOTS + 1); i <= tick; i++) {
+		sweepSlot(i, tick);
+	}
+	last_tick = tick;
+
+	timer.expires_from_now(boost::posix_time::seconds(1));
+	timer.async_wait(std::bind(&TimingWheel::sweep, this, std::placeholders::_1));
+}
+
+void TimingWheel::sweepSlot(int64_t slot_tick, int64_t tick)
+{
+	std::vector<ConnectionWeak_ptr>& slot = slots[slot_tick % TIMING_WHEEL_SLOTS];
+	if (slot.empty()) {
+		return;
+	}
+
+	// connections may be filed back into this very slot
+	sweeping.swap(slot);
+
+	for (const ConnectionWeak_ptr& connection_weak : sweeping) {
+		const Connection_ptr connection = connection_weak.lock();
+		if (!connection || !connection->getSocket().is_open()) {
+			continue;
+		}
+
+		int64_t deadline = connection->getDeadline();
+		if (deadline == 0) {
+			// neither reading nor writing, the game thread has the connection paused
+			deadline = tick + CONNECTION_READ_TIMEOUT;
+		} else if (deadline <= tick) {
+			// a connection already closed is only waiting for its last write
+			connection->close();
+			connection->closeSocket();
+			continue;
+		}
+
+		slots[deadline % TIMING_WHEEL_SLOTS].emplace_back(connection_weak);
+	}
+
+	sweeping.clear();
+}
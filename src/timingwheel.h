@@ -0,0 +1,41 @@
+#pragma once
+
+#include "connection.h"
+
+static constexpr size_t TIMING_WHEEL_SLOTS = 64;
+static_assert(CONNECTION_READ_TIMEOUT < TIMING_WHEEL_SLOTS && CONNECTION_WRITE_TIMEOUT < TIMING_WHEEL_SLOTS,
+	"a connection deadline has to fit in one turn of the wheel");
+
+// Read and write timeouts of the connections of one I/O thread, checked once per second.
+// Connections only store their deadlines when they read or write, the wheel looks at each connection
+// when its slot comes up and either times it out or files it under the slot of its current deadline.
+class TimingWheel
+{
+public:
+	explicit TimingWheel(boost::asio::io_service& io_service) :
+		timer(io_service) {
+		//
+	}
+
+	TimingWheel(const TimingWheel&) = delete;
+	TimingWheel& operator=(const TimingWheel&) = delete;
+
+	// seconds of a steady clock, the unit of connection deadlines
+	static int64_t getTick() {
+		return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void start();
+	void stop();
+
+	// only from the thread running the io_service
+	void addConnection(const Connection_ptr& connection);
+private:
+	void sweep(const boost::system::error_code& error);
+	void sweepSlot(int64_t slot_tick, int64_t tick);
+
+	boost::asio::deadline_timer timer;
+	std::array<std::vector<ConnectionWeak_ptr>, TIMING_WHEEL_SLOTS> slots;
+	std::vector<ConnectionWeak_ptr> sweeping;
+	int64_t last_tick = 0;
+};
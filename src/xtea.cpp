@@ -0,0 +1,335 @@
+#include "pch.h"
+
+#include "xtea.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define XTEA_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(XTEA_X86) && defined(__GNUC__)
+#define XTEA_TARGET_SSE2 __attribute__((target("sse2")))
+#define XTEA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define XTEA_TARGET_SSE2
+#define XTEA_TARGET_AVX2
+#endif
+
+static constexpr uint32_t XTEA_DELTA = 0x61C88647;
+static constexpr uint32_t XTEA_ROUNDS = 32;
+
+// every block is ciphered with the same key, so the per round key material is computed once per call
+struct XTEARoundKeys
+{
+	uint32_t first[XTEA_ROUNDS];
+	uint32_t second[XTEA_ROUNDS];
+};
+
+static void encryptRoundKeys(const uint32_t* key, XTEARoundKeys& keys)
+{
+	uint32_t sum = 0;
+	for (uint32_t i = 0; i < XTEA_ROUNDS; i++) {
+		keys.first[i] = sum + key[sum & 3];
+		sum -= XTEA_DELTA;
+		keys.second[i] = sum + key[(sum >> 11) & 3];
+	}
+}
+
+static void decryptRoundKeys(const uint32_t* key, XTEARoundKeys& keys)
+{
+	uint32_t sum = 0xC6EF3720;
+	for (uint32_t i = 0; i < XTEA_ROUNDS; i++) {
+		keys.second[i] = sum + key[(sum >> 11) & 3];
+		sum += XTEA_DELTA;
+		keys.first[i] = sum + key[sum & 3];
+	}
+}
+
+static void encryptBlocks(uint8_t* buffer, uint32_t length, const XTEARoundKeys& keys)
+{
+	for (uint32_t pos = 0; pos < length; pos += 8) {
+		uint32_t v0, v1;
+		memcpy(&v0, buffer + pos, 4);
+		memcpy(&v1, buffer + pos + 4, 4);
+
+		for (uint32_t i = 0; i < XTEA_ROUNDS; i++) {
+			v0 += ((v1 << 4 ^ v1 >> 5) + v1) ^ keys.first[i];
+			v1 += ((v0 << 4 ^ v0 >> 5) + v0) ^ keys.second[i];
+		}
+
+		memcpy(buffer + pos, &v0, 4);
+		memcpy(buffer + pos + 4, &v1, 4);
+	}
+}
+
+static void decryptBlocks(uint8_t* buffer, uint32_t length, const XTEARoundKeys& keys)
+{
+	for (uint32_t pos = 0; pos < length; pos += 8) {
+		uint32_t v0, v1;
+		memcpy(&v0, buffer + pos, 4);
+		memcpy(&v1, buffer + pos + 4, 4);
+
+		for (uint32_t i = 0; i < XTEA_ROUNDS; i++) {
+			v1 -= ((v0 << 4 ^ v0 >> 5) + v0) ^ keys.second[i];
+			v0 -= ((v1 << 4 ^ v1 >> 5) + v1) ^ keys.first[i];
+		}
+
+		memcpy(buffer + pos, &v0, 4);
+		memcpy(buffer + pos + 4, &v1, 4);
+	}
+}
+
+#ifdef XTEA_X86
+// SSE2: four blocks per pass, v0 and v1 words are split into separate registers
+XTEA_TARGET_SSE2 static void encryptBlocksSSE2(uint8_t* buffer, uint32_t length, const XTEARoundKeys& keys)
+{
+	uint32_t pos = 0;
+	for (; pos + 32 <= length; pos += 32) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + pos));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + pos + 16));
+		__m128i v0 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+		__m128i v1 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+
+		for (uint32_t i = 0; i < XTEA_ROUNDS; i++) {
+			__m128i t = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v1, 4), _mm_srli_epi32(v1, 5)), v1);
+			v0 = _mm_add_epi32(v0, _mm_xor_si128(t, _mm_set1_epi32(static_cast<int32_t>(keys.first[i]))));
+			t = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v0, 4), _mm_srli_epi32(v0, 5)), v0);
+			v1 = _mm_add_epi32(v1, _mm_xor_si128(t, _mm_set1_epi32(static_cast<int32_t>(keys.second[i]))));
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + pos), _mm_unpacklo_epi32(v0, v1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + pos + 16), _mm_unpackhi_epi32(v0, v1));
+	}
+
+	encryptBlocks(buffer + pos, length - pos, keys);
+}
+
+XTEA_TARGET_SSE2 static void decryptBlocksSSE2(uint8_t* buffer, uint32_t length, const XTEARoundKeys& keys)
+{
+	uint32_t pos = 0;
+	for (; pos + 32 <= length; pos += 32) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + pos));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + pos + 16));
+		__m128i v0 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+		__m128i v1 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+
+		for (uint32_t i = 0; i < XTEA_ROUNDS; i++) {
+			__m128i t = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v0, 4), _mm_srli_epi32(v0, 5)), v0);
+			v1 = _mm_sub_epi32(v1, _mm_xor_si128(t, _mm_set1_epi32(static_cast<int32_t>(keys.second[i]))));
+			t = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v1, 4), _mm_srli_epi32(v1, 5)), v1);
+			v0 = _mm_sub_epi32(v0, _mm_xor_si128(t, _mm_set1_epi32(static_cast<int32_t>(keys.first[i]))));
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + pos), _mm_unpacklo_epi32(v0, v1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + pos + 16), _mm_unpackhi_epi32(v0, v1));
+	}
+
+	decryptBlocks(buffer + pos, length - pos, keys);
+}
+
+// AVX2: eight blocks per pass, the in-lane shuffles permute blocks but unpack restores the order
+XTEA_TARGET_AVX2 static void encryptBlocksAVX2(uint8_t* buffer, uint32_t length, const XTEARoundKeys& keys)
+{
+	uint32_t pos = 0;
+	for (; pos + 64 <= length; pos += 64) {
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + pos));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + pos + 32));
+		__m256i v0 = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+		__m256i v1 = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+
+		for (uint32_t i = 0; i < XTEA_ROUNDS; i++) {
+			__m256i t = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v1, 4), _mm256_srli_epi32(v1, 5)), v1);
+			v0 = _mm256_add_epi32(v0, _mm256_xor_si256(t, _mm256_set1_epi32(static_cast<int32_t>(keys.first[i]))));
+			t = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v0, 4), _mm256_srli_epi32(v0, 5)), v0);
+			v1 = _mm256_add_epi32(v1, _mm256_xor_si256(t, _mm256_set1_epi32(static_cast<int32_t>(keys.second[i]))));
+		}
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer + pos), _mm256_unpacklo_epi32(v0, v1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer + pos + 32), _mm256_unpackhi_epi32(v0, v1));
+	}
+
+	encryptBlocksSSE2(buffer + pos, length - pos, keys);
+}
+
+XTEA_TARGET_AVX2 static void decryptBlocksAVX2(uint8_t* buffer, uint32_t length, const XTEARoundKeys& keys)
+{
+	uint32_t pos = 0;
+	for (; pos + 64 <= length; pos += 64) {
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + pos));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + pos + 32));
+		__m256i v0 = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+		__m256i v1 = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+
+		for (uint32_t i = 0; i < XTEA_ROUNDS; i++) {
+			__m256i t = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v0, 4), _mm256_srli_epi32(v0, 5)), v0);
+			v1 = _mm256_sub_epi32(v1, _mm256_xor_si256(t, _mm256_set1_epi32(static_cast<int32_t>(keys.second[i]))));
+			t = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v1, 4), _mm256_srli_epi32(v1, 5)), v1);
+			v0 = _mm256_sub_epi32(v0, _mm256_xor_si256(t, _mm256_set1_epi32(static_cast<int32_t>(keys.first[i]))));
+		}
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer + pos), _mm256_unpacklo_epi32(v0, v1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer + pos + 32), _mm256_unpackhi_epi32(v0, v1));
+	}
+
+	decryptBlocksSSE2(buffer + pos, length - pos, keys);
+}
+
+static bool cpuSupportsSSE2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool cpuSupportsAVX2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+
+	// the OS has to save the ymm registers as well
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+struct XTEAKernel
+{
+	const char* name;
+	void (*encrypt)(uint8_t*, uint32_t, const XTEARoundKeys&);
+	void (*decrypt)(uint8_t*, uint32_t, const XTEARoundKeys&);
+};
+
+#ifdef XTEA_X86
+static const XTEAKernel XTEA_KERNELS[XTEA_KERNEL_COUNT] = {
+	{ "scalar", encryptBlocks, decryptBlocks },
+	{ "sse2", encryptBlocksSSE2, decryptBlocksSSE2 },
+	{ "avx2", encryptBlocksAVX2, decryptBlocksAVX2 },
+};
+#else
+static const XTEAKernel XTEA_KERNELS[XTEA_KERNEL_COUNT] = {
+	{ "scalar", encryptBlocks, decryptBlocks },
+	{ "sse2", encryptBlocks, decryptBlocks },
+	{ "avx2", encryptBlocks, decryptBlocks },
+};
+#endif
+
+// a vector kernel is only used if it matches the scalar code bit for bit
+static bool verifyKernel(const XTEAKernel& kernel)
+{
+	const uint32_t key[4] = { 0x01234567, 0x89ABCDEF, 0xFEDCBA98, 0x76543210 };
+	XTEARoundKeys encrypt_keys, decrypt_keys;
+	encryptRoundKeys(key, encrypt_keys);
+	decryptRoundKeys(key, decrypt_keys);
+
+	// odd block count so the scalar tail of every kernel is covered too
+	uint8_t plain[8 * 23], expected[8 * 23], result[8 * 23];
+	for (uint32_t i = 0; i < sizeof(plain); i++) {
+		plain[i] = static_cast<uint8_t>(i * 31 + 7);
+	}
+
+	memcpy(expected, plain, sizeof(plain));
+	encryptBlocks(expected, sizeof(expected), encrypt_keys);
+
+	memcpy(result, plain, sizeof(plain));
+	kernel.encrypt(result, sizeof(result), encrypt_keys);
+	if (memcmp(result, expected, sizeof(result)) != 0) {
+		return false;
+	}
+
+	kernel.decrypt(result, sizeof(result), decrypt_keys);
+	return memcmp(result, plain, sizeof(plain)) == 0;
+}
+
+static const XTEAKernel& selectKernel()
+{
+	if (XTEA::isKernelSupported(XTEA_KERNEL_AVX2)) {
+		if (verifyKernel(XTEA_KERNELS[XTEA_KERNEL_AVX2])) {
+			return XTEA_KERNELS[XTEA_KERNEL_AVX2];
+		}
+		fmt::printf("ERROR - XTEA::selectKernel: avx2 kernel does not match the scalar kernel.\n");
+	}
+
+	if (XTEA::isKernelSupported(XTEA_KERNEL_SSE2)) {
+		if (verifyKernel(XTEA_KERNELS[XTEA_KERNEL_SSE2])) {
+			return XTEA_KERNELS[XTEA_KERNEL_SSE2];
+		}
+		fmt::printf("ERROR - XTEA::selectKernel: sse2 kernel does not match the scalar kernel.\n");
+	}
+
+	return XTEA_KERNELS[XTEA_KERNEL_SCALAR];
+}
+
+static const XTEAKernel& getKernel()
+{
+	static const XTEAKernel& kernel = selectKernel();
+	return kernel;
+}
+
+void XTEA::encrypt(uint8_t* buffer, uint32_t length, const uint32_t* key)
+{
+	XTEARoundKeys keys;
+	encryptRoundKeys(key, keys);
+	getKernel().encrypt(buffer, length, keys);
+}
+
+void XTEA::decrypt(uint8_t* buffer, uint32_t length, const uint32_t* key)
+{
+	XTEARoundKeys keys;
+	decryptRoundKeys(key, keys);
+	getKernel().decrypt(buffer, length, keys);
+}
+
+bool XTEA::isKernelSupported(XTEAKernel_t kernel)
+{
+	switch (kernel) {
+		case XTEA_KERNEL_SCALAR: return true;
+#ifdef XTEA_X86
+		case XTEA_KERNEL_SSE2: return cpuSupportsSSE2();
+		case XTEA_KERNEL_AVX2: return cpuSupportsAVX2();
+#endif
+		default: return false;
+	}
+}
+
+void XTEA::encrypt(XTEAKernel_t kernel, uint8_t* buffer, uint32_t length, const uint32_t* key)
+{
+	XTEARoundKeys keys;
+	encryptRoundKeys(key, keys);
+	XTEA_KERNELS[kernel].encrypt(buffer, length, keys);
+}
+
+void XTEA::decrypt(XTEAKernel_t kernel, uint8_t* buffer, uint32_t length, const uint32_t* key)
+{
+	XTEARoundKeys keys;
+	decryptRoundKeys(key, keys);
+	XTEA_KERNELS[kernel].decrypt(buffer, length, keys);
+}
+
+const char* XTEA::getKernelName()
+{
+	return getKernel().name;
+}
+
+const char* XTEA::getKernelName(XTEAKernel_t kernel)
+{
+	return XTEA_KERNELS[kernel].name;
+}
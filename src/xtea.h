@@ -0,0 +1,26 @@
+#pragma once
+
+enum XTEAKernel_t : uint8_t
+{
+	XTEA_KERNEL_SCALAR,
+	XTEA_KERNEL_SSE2,
+	XTEA_KERNEL_AVX2,
+
+	XTEA_KERNEL_COUNT,
+};
+
+class XTEA
+{
+public:
+	// length must be a multiple of 8, blocks are processed in place
+	static void encrypt(uint8_t* buffer, uint32_t length, const uint32_t* key);
+	static void decrypt(uint8_t* buffer, uint32_t length, const uint32_t* key);
+
+	// a specific kernel regardless of the one selected at startup, used by the xtea test and benchmark
+	static bool isKernelSupported(XTEAKernel_t kernel);
+	static void encrypt(XTEAKernel_t kernel, uint8_t* buffer, uint32_t length, const uint32_t* key);
+	static void decrypt(XTEAKernel_t kernel, uint8_t* buffer, uint32_t length, const uint32_t* key);
+
+	static const char* getKernelName();
+	static const char* getKernelName(XTEAKernel_t kernel);
+};
@@ -0,0 +1,60 @@
+#include "pch.h"
+
+#include "xtea.h"
+#include "messagepool.h"
+
+// runs each kernel over one message of every pool size class for a fixed time and prints the throughput
+static constexpr std::chrono::milliseconds BENCH_DURATION{ 500 };
+
+static double measure(bool encrypt, XTEAKernel_t kernel, std::vector<uint8_t>& buffer, const uint32_t* key)
+{
+	using clock = std::chrono::steady_clock;
+
+	uint64_t bytes = 0;
+	const clock::time_point start = clock::now();
+	clock::time_point now = start;
+	while (now - start < BENCH_DURATION) {
+		for (uint32_t i = 0; i < 64; i++) {
+			if (encrypt) {
+				XTEA::encrypt(kernel, buffer.data(), static_cast<uint32_t>(buffer.size()), key);
+			} else {
+				XTEA::decrypt(kernel, buffer.data(), static_cast<uint32_t>(buffer.size()), key);
+			}
+		}
+		bytes += buffer.size() * 64;
+		now = clock::now();
+	}
+
+	const double seconds = std::chrono::duration<double>(now - start).count();
+	return bytes / seconds / (1024 * 1024);
+}
+
+int main()
+{
+	fmt::printf(":: RealOTS XTEA kernel benchmark\n\n");
+
+	const uint32_t key[4] = { 0x01234567, 0x89ABCDEF, 0xFEDCBA98, 0x76543210 };
+
+	fmt::printf("%-8s %8s %14s %14s\n", "kernel", "bytes", "encrypt MB/s", "decrypt MB/s");
+	for (uint8_t i = XTEA_KERNEL_SCALAR; i != XTEA_KERNEL_COUNT; i++) {
+		const XTEAKernel_t kernel = static_cast<XTEAKernel_t>(i);
+		if (!XTEA::isKernelSupported(kernel)) {
+			fmt::printf("%-8s not supported by this CPU\n", XTEA::getKernelName(kernel));
+			continue;
+		}
+
+		for (uint8_t size_class = MESSAGE_SIZE_SMALL; size_class != MESSAGE_SIZE_COUNT; size_class++) {
+			std::vector<uint8_t> buffer(MessagePool::getCapacity(static_cast<MessageSize_t>(size_class)));
+			for (size_t j = 0; j < buffer.size(); j++) {
+				buffer[j] = static_cast<uint8_t>(j * 31 + 7);
+			}
+
+			const double encrypt_rate = measure(true, kernel, buffer, key);
+			const double decrypt_rate = measure(false, kernel, buffer, key);
+			fmt::printf("%-8s %8d %14.1f %14.1f\n", XTEA::getKernelName(kernel), buffer.size(), encrypt_rate, decrypt_rate);
+		}
+	}
+
+	fmt::printf("\n>> The server uses the %s kernel on this CPU.\n", XTEA::getKernelName());
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include "pch.h"
+
+#include "xtea.h"
+#include "messagepool.h"
+
+// checks every vector kernel the CPU supports against the scalar kernel, bit for bit
+static constexpr uint32_t TEST_KEYS = 64;
+
+// every block count up to two AVX2 passes plus one, then the message pool size classes
+static std::vector<uint32_t> getTestLengths()
+{
+	std::vector<uint32_t> lengths;
+	for (uint32_t blocks = 0; blocks <= 17; blocks++) {
+		lengths.push_back(blocks * 8);
+	}
+
+	for (uint8_t size_class = MESSAGE_SIZE_SMALL; size_class != MESSAGE_SIZE_COUNT; size_class++) {
+		const uint32_t capacity = MessagePool::getCapacity(static_cast<MessageSize_t>(size_class));
+		lengths.push_back(capacity);
+		lengths.push_back(capacity - 8);
+		lengths.push_back(capacity - 24);
+	}
+	return lengths;
+}
+
+static bool testKernel(XTEAKernel_t kernel, std::mt19937& random)
+{
+	const std::vector<uint32_t> lengths = getTestLengths();
+	uint32_t failures = 0;
+
+	for (uint32_t k = 0; k < TEST_KEYS; k++) {
+		uint32_t key[4];
+		for (uint32_t& word : key) {
+			word = random();
+		}
+
+		for (uint32_t length : lengths) {
+			// unaligned starts, the kernels load and store without alignment requirements
+			const uint32_t offset = random() % 16;
+
+			std::vector<uint8_t> plain(length);
+			for (uint8_t& byte : plain) {
+				byte = static_cast<uint8_t>(random());
+			}
+
+			std::vector<uint8_t> expected(plain);
+			XTEA::encrypt(XTEA_KERNEL_SCALAR, expected.data(), length, key);
+
+			std::vector<uint8_t> buffer(length + offset);
+			memcpy(buffer.data() + offset, plain.data(), length);
+			XTEA::encrypt(kernel, buffer.data() + offset, length, key);
+			if (memcmp(buffer.data() + offset, expected.data(), length) != 0) {
+				fmt::printf("ERROR - %s encrypt differs from scalar (length %d, offset %d, key %08X%08X%08X%08X).\n",
+					XTEA::getKernelName(kernel), length, offset, key[0], key[1], key[2], key[3]);
+				failures++;
+				continue;
+			}
+
+			// random bytes decrypted by both kernels, not only the round trip
+			std::vector<uint8_t> scalar_plain(plain);
+			XTEA::decrypt(XTEA_KERNEL_SCALAR, scalar_plain.data(), length, key);
+			std::vector<uint8_t> kernel_plain(plain);
+			XTEA::decrypt(kernel, kernel_plain.data(), length, key);
+			if (scalar_plain != kernel_plain) {
+				fmt::printf("ERROR - %s decrypt differs from scalar (length %d, key %08X%08X%08X%08X).\n",
+					XTEA::getKernelName(kernel), length, key[0], key[1], key[2], key[3]);
+				failures++;
+				continue;
+			}
+
+			XTEA::decrypt(kernel, buffer.data() + offset, length, key);
+			if (memcmp(buffer.data() + offset, plain.data(), length) != 0) {
+				fmt::printf("ERROR - %s round trip failed (length %d, offset %d).\n", XTEA::getKernelName(kernel), length, offset);
+				failures++;
+			}
+		}
+	}
+
+	fmt::printf(">> %s: %d keys, %d lengths, %d failures.\n", XTEA::getKernelName(kernel), TEST_KEYS, lengths.size(), failures);
+	return failures == 0;
+}
+
+int main(int argc, char** argv)
+{
+	fmt::printf(":: RealOTS XTEA kernel test\n\n");
+
+	const uint32_t seed = argc > 1 ? std::stoul(argv[1]) : static_cast<uint32_t>(time(nullptr));
+	fmt::printf(">> Seed %d.\n", seed);
+	std::mt19937 random(seed);
+
+	bool passed = true;
+	for (uint8_t i = XTEA_KERNEL_SSE2; i != XTEA_KERNEL_COUNT; i++) {
+		const XTEAKernel_t kernel = static_cast<XTEAKernel_t>(i);
+		if (!XTEA::isKernelSupported(kernel)) {
+			fmt::printf(">> %s: not supported by this CPU, skipped.\n", XTEA::getKernelName(kernel));
+			continue;
+		}
+
+		passed &= testKernel(kernel, random);
+	}
+
+	fmt::printf(passed ? ">> Passed.\n" : ">> FAILED.\n");
+	return passed ? 0 : 1;
+}